@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AISignificanceSubsystem.h"
+
+#include "AIController.h"
+#include "AIVisibilitySubsystem.h"
+#include "ShooterTemplate.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+
+static FAutoConsoleCommandWithWorld AISignificanceStatsCommand(
+	TEXT("Shooter.AISignificance.Stats"),
+	TEXT("Log how many AI are in each significance bucket."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		const UAISignificanceSubsystem* Significance = World ? World->GetSubsystem<UAISignificanceSubsystem>() : nullptr;
+		if (Significance)
+		{
+			const TArray<int32>& Counts = Significance->GetBucketCounts();
+			for (int32 Bucket = 0; Bucket < Counts.Num(); ++Bucket)
+			{
+				UE_LOG(LogTemp, Log, TEXT("AI significance bucket %d: %d AI"), Bucket, Counts[Bucket]);
+			}
+		}
+	}));
+
+void UAISignificanceSubsystem::RegisterController(AAIController* Controller)
+{
+	if (Controller == nullptr || ControllerIndices.Contains(Controller))
+	{
+		return;
+	}
+
+	// No bucket yet, so the first update applies rates
+	ControllerIndices.Add(Controller, Controllers.Num());
+	Controllers.Add(Controller);
+	ControllerBuckets.Add(INDEX_NONE);
+}
+
+void UAISignificanceSubsystem::UnregisterController(AAIController* Controller)
+{
+	int32 Index;
+	if (!ControllerIndices.RemoveAndCopyValue(Controller, Index))
+	{
+		return;
+	}
+
+	Controllers.RemoveAtSwap(Index, 1, false);
+	ControllerBuckets.RemoveAtSwap(Index, 1, false);
+
+	// The last controller took the removed one's place
+	if (Controllers.IsValidIndex(Index))
+	{
+		ControllerIndices.Add(Controllers[Index].Get(), Index);
+	}
+}
+
+float UAISignificanceSubsystem::GetServiceIntervalScale(const AController* Controller) const
+{
+	const int32* Index = ControllerIndices.Find(Controller);
+	if (Index == nullptr || !Buckets.IsValidIndex(ControllerBuckets[*Index]))
+	{
+		return 1.f;
+	}
+	return Buckets[ControllerBuckets[*Index]].ServiceIntervalScale;
+}
+
+void UAISignificanceSubsystem::Tick(float DeltaTime)
+{
+	TimeUntilUpdate -= DeltaTime;
+	if (TimeUntilUpdate <= 0.f)
+	{
+		TimeUntilUpdate = UpdateInterval;
+		UpdateSignificance();
+	}
+}
+
+bool UAISignificanceSubsystem::IsTickable() const
+{
+	return !IsTemplate() && Controllers.Num() > 0 && Buckets.Num() > 0;
+}
+
+TStatId UAISignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAISignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UAISignificanceSubsystem::UpdateSignificance()
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterAISignificance);
+	UWorld* World = GetWorld();
+
+	// Every player's view, on a dedicated server as well as locally
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+	TArray<FVector, TInlineAllocator<4>> ViewDirections;
+	TArray<const APawn*, TInlineAllocator<4>> PlayerPawns;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (PlayerController == nullptr)
+		{
+			continue;
+		}
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		ViewLocations.Add(ViewLocation);
+		ViewDirections.Add(ViewRotation.Vector());
+		PlayerPawns.Add(PlayerController->GetPawn());
+	}
+
+	UAIVisibilitySubsystem* Visibility = World->GetSubsystem<UAIVisibilitySubsystem>();
+	const float ViewConeCos = FMath::Cos(FMath::DegreesToRadians(ViewConeHalfAngle));
+	BucketCounts.Init(0, Buckets.Num());
+
+	for (int32 Index = 0; Index < Controllers.Num(); ++Index)
+	{
+		AAIController* Controller = Controllers[Index].Get();
+		const APawn* Pawn = Controller ? Controller->GetPawn() : nullptr;
+		if (Pawn == nullptr)
+		{
+			continue;
+		}
+
+		float NearestDistanceSquared = MAX_flt;
+		bool bSeen = false;
+		for (int32 Player = 0; Player < ViewLocations.Num(); ++Player)
+		{
+			const FVector ToPawn = Pawn->GetActorLocation() - ViewLocations[Player];
+			const float DistanceSquared = ToPawn.SizeSquared();
+			NearestDistanceSquared = FMath::Min(NearestDistanceSquared, DistanceSquared);
+
+			// In front of the player and with a clear line of sight. The cached result is symmetric enough
+			const bool bInViewCone = (ToPawn | ViewDirections[Player]) > ViewConeCos * FMath::Sqrt(DistanceSquared);
+			bool bVisible;
+			float ResultAge;
+			if (!bSeen && bInViewCone && Visibility && PlayerPawns[Player] &&
+				Visibility->GetVisibility(Controller, PlayerPawns[Player], bVisible, ResultAge, UpdateInterval))
+			{
+				bSeen = bVisible;
+			}
+		}
+
+		int32 Bucket = Buckets.Num() - 1;
+		for (int32 Candidate = 0; Candidate < Buckets.Num() - 1; ++Candidate)
+		{
+			if (NearestDistanceSquared <= FMath::Square(Buckets[Candidate].MaxDistance))
+			{
+				Bucket = Candidate;
+				break;
+			}
+		}
+		if (bSeen)
+		{
+			Bucket = FMath::Min(Bucket, VisibleBucketLimit);
+		}
+
+		++BucketCounts[Bucket];
+		if (Bucket != ControllerBuckets[Index])
+		{
+			ControllerBuckets[Index] = Bucket;
+			ApplyBucket(Controller, Bucket);
+		}
+	}
+}
+
+void UAISignificanceSubsystem::ApplyBucket(AAIController* Controller, int32 BucketIndex) const
+{
+	const FAISignificanceBucket& Bucket = Buckets[BucketIndex];
+	Controller->SetActorTickInterval(Bucket.ControllerTickInterval);
+
+	const ACharacter* Character = Cast<ACharacter>(Controller->GetPawn());
+	if (Character && Character->GetCharacterMovement())
+	{
+		Character->GetCharacterMovement()->SetComponentTickInterval(Bucket.MovementTickInterval);
+	}
+}
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "AISignificanceSubsystem.generated.h"
+
+class AAIController;
+
+/** Update rates for AI in one significance bucket. Buckets are listed nearest first in DefaultGame.ini */
+USTRUCT()
+struct FAISignificanceBucket
+{
+	GENERATED_BODY()
+
+	/** AI within this distance of a player and not in a nearer bucket land here. The last bucket takes the rest */
+	UPROPERTY()
+	float MaxDistance{0.f};
+
+	/** Tick interval of the AI controller. Zero ticks every frame */
+	UPROPERTY()
+	float ControllerTickInterval{0.f};
+
+	/** Tick interval of the pawn's character movement. Zero ticks every frame */
+	UPROPERTY()
+	float MovementTickInterval{0.f};
+
+	/** Multiplier on the interval of the module's behavior tree services */
+	UPROPERTY()
+	float ServiceIntervalScale{1.f};
+};
+
+/**
+ * Buckets every registered AI controller by its distance to the nearest player, and by whether a
+ * player can see it, then scales how often the AI thinks and moves to match its bucket.
+ */
+UCLASS(Config = Game)
+class SHOOTERTEMPLATE_API UAISignificanceSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+public:
+	void RegisterController(AAIController* Controller);
+	void UnregisterController(AAIController* Controller);
+
+	/** Service interval multiplier for an AI, 1 if it isn't registered */
+	float GetServiceIntervalScale(const AController* Controller) const;
+
+	/** Number of AI in each bucket as of the last update */
+	FORCEINLINE const TArray<int32>& GetBucketCounts() const { return BucketCounts; }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+private:
+	/** Re-bucket every registered AI and apply rates to the ones that changed bucket */
+	void UpdateSignificance();
+
+	void ApplyBucket(AAIController* Controller, int32 BucketIndex) const;
+
+	/** Nearest bucket first */
+	UPROPERTY(Config)
+	TArray<FAISignificanceBucket> Buckets;
+
+	/** AI a player can see are never put in a bucket further than this one */
+	UPROPERTY(Config)
+	int32 VisibleBucketLimit{0};
+
+	/** Half angle of the cone in front of a player's view that counts as seen */
+	UPROPERTY(Config)
+	float ViewConeHalfAngle{60.f};
+
+	/** Seconds between re-bucketing passes */
+	UPROPERTY(Config)
+	float UpdateInterval{0.25f};
+
+	TArray<TWeakObjectPtr<AAIController>> Controllers;
+
+	/** Current bucket of each entry in Controllers */
+	TArray<int32> ControllerBuckets;
+
+	TMap<const AController*, int32> ControllerIndices;
+
+	TArray<int32> BucketCounts;
+
+	float TimeUntilUpdate{0.f};
+};
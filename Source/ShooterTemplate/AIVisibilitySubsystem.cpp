@@ -0,0 +1,233 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AIVisibilitySubsystem.h"
+
+#include "ShooterTemplate.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "Misc/Paths.h"
+
+static FAutoConsoleCommandWithWorld AIVisibilityStatsCommand(
+	TEXT("Shooter.AIVisibility.Stats"),
+	TEXT("Log how many line of sight refreshes the baked grid answered and how many needed a trace."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		const UAIVisibilitySubsystem* Visibility = World ? World->GetSubsystem<UAIVisibilitySubsystem>() : nullptr;
+		if (Visibility)
+		{
+			const int64 Total = FMath::Max<int64>(Visibility->GetNumGridAnswers() + Visibility->GetNumTraces(), 1);
+			UE_LOG(LogTemp, Log, TEXT("AI visibility: grid %s, %lld grid answers, %lld traces, %.1f%% traces avoided"),
+			       Visibility->HasVisibilityGrid() ? TEXT("loaded") : TEXT("missing"), Visibility->GetNumGridAnswers(),
+			       Visibility->GetNumTraces(), 100.0 * Visibility->GetNumGridAnswers() / Total);
+		}
+	}));
+
+void UAIVisibilitySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	TraceDelegate.BindUObject(this, &UAIVisibilitySubsystem::OnTraceDone);
+
+	// Baked offline by the BakeVisibilityGrid commandlet. Maps without one trace every refresh
+	const FString MapName = UWorld::RemovePIEPrefix(GetWorld()->GetMapName());
+	Grid.Load(FPaths::ProjectContentDir() / GridDirectory / MapName + TEXT(".pvs"));
+}
+
+void UAIVisibilitySubsystem::Deinitialize()
+{
+	Grid.Unload();
+	Super::Deinitialize();
+}
+
+void UAIVisibilitySubsystem::RegisterDynamicOccluder(const AActor* Occluder)
+{
+	if (Occluder)
+	{
+		DynamicOccluders.AddUnique(Occluder);
+	}
+}
+
+void UAIVisibilitySubsystem::UnregisterDynamicOccluder(const AActor* Occluder)
+{
+	DynamicOccluders.RemoveSingleSwap(Occluder, false);
+}
+
+bool UAIVisibilitySubsystem::GetVisibility(const AController* Observer, const AActor* Target, bool& bOutVisible,
+                                           float& OutAge, float KeepAliveTime)
+{
+	if (Observer == nullptr || Target == nullptr)
+	{
+		return false;
+	}
+
+	// Callers that ask rarely, like far AI on a scaled service interval, must still find the pair next time
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float ExpireTime = Now + FMath::Max(KeepAliveTime, 0.f) + QueryExpiryTime;
+	const uint64 Key = MakeKey(Observer, Target);
+	const int32* ExistingIndex = QueryIndexByKey.Find(Key);
+	if (ExistingIndex == nullptr)
+	{
+		// First time anyone asked, traced on a later frame
+		FVisibilityQuery& Query = Queries.AddDefaulted_GetRef();
+		Query.Key = Key;
+		Query.Observer = Observer;
+		Query.Target = Target;
+		Query.ExpireTime = ExpireTime;
+		QueryIndexByKey.Add(Key, Queries.Num() - 1);
+		return false;
+	}
+
+	FVisibilityQuery& Query = Queries[*ExistingIndex];
+	Query.ExpireTime = FMath::Max(Query.ExpireTime, ExpireTime);
+	if (!Query.bHasResult)
+	{
+		return false;
+	}
+	bOutVisible = Query.bVisible;
+	OutAge = Now - Query.LastTraceTime;
+	return true;
+}
+
+void UAIVisibilitySubsystem::Tick(float DeltaTime)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterAIVisibility);
+	UWorld* World = GetWorld();
+	const float Now = World->GetTimeSeconds();
+
+	// Forget pairs that went away or that nobody asks about anymore
+	for (int32 Index = Queries.Num() - 1; Index >= 0; --Index)
+	{
+		const FVisibilityQuery& Query = Queries[Index];
+		const bool bExpired = !Query.Observer.IsValid() || !Query.Target.IsValid()
+			|| Now > Query.ExpireTime;
+		if (bExpired && !Query.PendingTrace.IsValid())
+		{
+			RemoveQuery(Index);
+		}
+	}
+
+	// Refresh the next pairs in line, within the trace budget
+	const int32 Num = Queries.Num();
+	int32 TracesStarted = 0;
+	int32 GridAnswers = 0;
+	for (int32 Step = 0; Step < Num && TracesStarted < MaxTracesPerFrame; ++Step)
+	{
+		const int32 Index = (RefreshCursor + Step) % Num;
+		FVisibilityQuery& Query = Queries[Index];
+		if (Query.PendingTrace.IsValid() || (Query.bHasResult && Now - Query.LastTraceTime < MinRefreshInterval))
+		{
+			continue;
+		}
+
+		const AController* Observer = Query.Observer.Get();
+		const AActor* Target = Query.Target.Get();
+		const APawn* ObserverPawn = Observer ? Observer->GetPawn() : nullptr;
+		if (ObserverPawn == nullptr || Target == nullptr)
+		{
+			continue;
+		}
+
+		// Same ray as AController::LineOfSightTo: from the eyes to the target location
+		FVector ViewPoint;
+		FRotator ViewRotation;
+		ObserverPawn->GetActorEyesViewPoint(ViewPoint, ViewRotation);
+		const FVector TargetLocation = Target->GetTargetLocation(ObserverPawn);
+		RefreshCursor = Index + 1;
+
+		// Static geometry only, so anything movable in the way needs the real trace
+		const EVisibilityGridResult GridResult = Grid.Query(ViewPoint, TargetLocation);
+		if (GridResult != EVisibilityGridResult::Unknown && !IsDynamicallyOccluded(ViewPoint, TargetLocation))
+		{
+			Query.bVisible = GridResult == EVisibilityGridResult::Visible;
+			Query.bHasResult = true;
+			Query.LastTraceTime = Now;
+			++GridAnswers;
+			continue;
+		}
+
+		FCollisionQueryParams Params(SCENE_QUERY_STAT(AIVisibility), true, ObserverPawn);
+		Params.AddIgnoredActor(Target);
+		Query.PendingTrace = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, ViewPoint, TargetLocation,
+		                                                    ECollisionChannel::ECC_Visibility, Params,
+		                                                    FCollisionResponseParams::DefaultResponseParam,
+		                                                    &TraceDelegate, Index);
+		++TracesStarted;
+	}
+	NumGridAnswers += GridAnswers;
+	NumTraces += TracesStarted;
+	SHOOTER_INC_COUNTER(STAT_ShooterLOSChecks, TracesStarted + GridAnswers);
+	SHOOTER_INC_COUNTER(STAT_ShooterLOSGridAnswers, GridAnswers);
+	SHOOTER_INC_COUNTER(STAT_ShooterTraces, TracesStarted);
+}
+
+bool UAIVisibilitySubsystem::IsTickable() const
+{
+	return !IsTemplate() && Queries.Num() > 0;
+}
+
+TStatId UAIVisibilitySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAIVisibilitySubsystem, STATGROUP_Tickables);
+}
+
+void UAIVisibilitySubsystem::OnTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	// UserData is the query index at submit time. It only goes stale if queries were removed since
+	int32 Index = static_cast<int32>(Datum.UserData);
+	if (!Queries.IsValidIndex(Index) || !(Queries[Index].PendingTrace == Handle))
+	{
+		Index = Queries.IndexOfByPredicate([&Handle](const FVisibilityQuery& Query)
+		{
+			return Query.PendingTrace == Handle;
+		});
+		if (Index == INDEX_NONE)
+		{
+			return;
+		}
+	}
+
+	FVisibilityQuery& Query = Queries[Index];
+	Query.PendingTrace = FTraceHandle();
+	Query.bVisible = Datum.OutHits.Num() == 0 || !Datum.OutHits[0].bBlockingHit;
+	Query.bHasResult = true;
+	Query.LastTraceTime = GetWorld()->GetTimeSeconds();
+}
+
+bool UAIVisibilitySubsystem::IsDynamicallyOccluded(const FVector& From, const FVector& To)
+{
+	const FVector Direction = To - From;
+	for (int32 Index = DynamicOccluders.Num() - 1; Index >= 0; --Index)
+	{
+		const AActor* Occluder = DynamicOccluders[Index].Get();
+		if (Occluder == nullptr)
+		{
+			DynamicOccluders.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+		if (FMath::LineBoxIntersection(Occluder->GetComponentsBoundingBox(), From, To, Direction))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void UAIVisibilitySubsystem::RemoveQuery(int32 Index)
+{
+	QueryIndexByKey.Remove(Queries[Index].Key);
+	Queries.RemoveAtSwap(Index, 1, false);
+
+	// The last query took the removed one's place
+	if (Queries.IsValidIndex(Index))
+	{
+		QueryIndexByKey.Add(Queries[Index].Key, Index);
+	}
+}
+
+uint64 UAIVisibilitySubsystem::MakeKey(const AController* Observer, const AActor* Target)
+{
+	const uint64 ObserverId = Observer ? Observer->GetUniqueID() : 0;
+	const uint64 TargetId = Target ? Target->GetUniqueID() : 0;
+	return ObserverId << 32 | TargetId;
+}
@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "VisibilityGrid.h"
+#include "WorldCollision.h"
+#include "AIVisibilitySubsystem.generated.h"
+
+/**
+ * Owns every AI-to-target line of sight check in the world. Callers ask for a result and get the
+ * cached one; the question is remembered and refreshed in round-robin order with async traces, never
+ * more than MaxTracesPerFrame per frame. Questions asked by several callers are only traced once, and
+ * questions nobody asked about for QueryExpiryTime past when their callers said they would ask again are
+ * dropped.
+ *
+ * If the map has a baked visibility grid, a refresh is answered from the grid instead of a trace,
+ * unless a registered dynamic occluder lies across the ray.
+ */
+UCLASS(Config = Game)
+class SHOOTERTEMPLATE_API UAIVisibilitySubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * Cached line of sight from Observer's pawn to Target
+	 * @param OutAge seconds since the result was traced
+	 * @param KeepAliveTime seconds until the caller asks again. The pair is kept and refreshed at least that long
+	 * @return false if the pair has not been traced yet
+	 */
+	bool GetVisibility(const AController* Observer, const AActor* Target, bool& bOutVisible, float& OutAge,
+	                   float KeepAliveTime = 0.f);
+
+	/** A movable actor that blocks sight. Rays crossing its bounds are traced even where the grid has an answer */
+	UFUNCTION(BlueprintCallable, Category = AI)
+	void RegisterDynamicOccluder(const AActor* Occluder);
+
+	UFUNCTION(BlueprintCallable, Category = AI)
+	void UnregisterDynamicOccluder(const AActor* Occluder);
+
+	FORCEINLINE bool HasVisibilityGrid() const { return Grid.IsLoaded(); }
+
+	/** Refreshes answered by the grid and by traces since the world started */
+	FORCEINLINE int64 GetNumGridAnswers() const { return NumGridAnswers; }
+	FORCEINLINE int64 GetNumTraces() const { return NumTraces; }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+private:
+	struct FVisibilityQuery
+	{
+		/** Key in QueryIndexByKey, kept so the entry can be removed after the pair is gone */
+		uint64 Key{0};
+		TWeakObjectPtr<const AController> Observer;
+		TWeakObjectPtr<const AActor> Target;
+		bool bVisible{false};
+		bool bHasResult{false};
+		float LastTraceTime{0.f};
+		/** Dropped after this, unless asked about again */
+		float ExpireTime{0.f};
+		/** Trace in flight for this query, if any */
+		FTraceHandle PendingTrace;
+	};
+
+	void OnTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	/** True if a dynamic occluder's bounds cross the ray */
+	bool IsDynamicallyOccluded(const FVector& From, const FVector& To);
+	void RemoveQuery(int32 Index);
+
+	static uint64 MakeKey(const AController* Observer, const AActor* Target);
+
+	/** Async traces started per frame, at most */
+	UPROPERTY(Config)
+	int32 MaxTracesPerFrame{16};
+
+	/** A pair isn't traced again sooner than this */
+	UPROPERTY(Config)
+	float MinRefreshInterval{0.1f};
+
+	/** Pairs nobody asked about for this long past their callers' keep alive time are forgotten */
+	UPROPERTY(Config)
+	float QueryExpiryTime{2.f};
+
+	/** Baked grids are read from <Map>.pvs in this directory under Content */
+	UPROPERTY(Config)
+	FString GridDirectory{TEXT("VisibilityGrids")};
+
+	FVisibilityGrid Grid;
+
+	TArray<TWeakObjectPtr<const AActor>> DynamicOccluders;
+
+	int64 NumGridAnswers{0};
+	int64 NumTraces{0};
+
+	TArray<FVisibilityQuery> Queries;
+
+	/** Bound once, passed to every async trace */
+	FTraceDelegate TraceDelegate;
+
+	/** Index into Queries for each observer/target pair */
+	TMap<uint64, int32> QueryIndexByKey;
+
+	/** Where the round-robin refresh picks up next frame */
+	int32 RefreshCursor{0};
+};
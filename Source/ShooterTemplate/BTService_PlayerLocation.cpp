@@ -3,8 +3,10 @@
 
 #include "BTService_PlayerLocation.h"
 
+#include "AISignificanceSubsystem.h"
+#include "ShooterAIController.h"
+#include "ShooterTemplate.h"
 #include "BehaviorTree/BlackboardComponent.h"
-#include "Kismet/GameplayStatics.h"
 
 UBTService_PlayerLocation::UBTService_PlayerLocation()
 {
@@ -13,12 +15,27 @@ UBTService_PlayerLocation::UBTService_PlayerLocation()
 
 void UBTService_PlayerLocation::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
 {
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterBTServices);
 	Super::TickNode(OwnerComp, NodeMemory, DeltaSeconds);
-	APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(GetWorld(), 0);
-	if (PlayerPawn == nullptr)
+
+	// Less significant AI run this service less often
+	if (const UAISignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UAISignificanceSubsystem>())
+	{
+		const float IntervalScale = Significance->GetServiceIntervalScale(OwnerComp.GetAIOwner());
+		SetNextTickTime(NodeMemory, GetNextTickRemainingTime(NodeMemory) * IntervalScale);
+	}
+
+	// Nearest player, from the spatial hash
+	const AShooterAIController* Controller = Cast<AShooterAIController>(OwnerComp.GetAIOwner());
+	if (Controller == nullptr)
+	{
+		return;
+	}
+	TArray<AActor*> Targets;
+	Controller->FindTargets(1, Targets);
+	if (Targets.Num() == 0)
 	{
 		return;
 	}
-	OwnerComp.GetBlackboardComponent()->SetValueAsVector(GetSelectedBlackboardKey(), PlayerPawn->GetActorLocation());
-	
+	OwnerComp.GetBlackboardComponent()->SetValueAsVector(GetSelectedBlackboardKey(), Targets[0]->GetActorLocation());
 }
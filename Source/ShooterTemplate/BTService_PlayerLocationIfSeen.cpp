@@ -4,8 +4,11 @@
 #include "BTService_PlayerLocationIfSeen.h"
 
 #include "AIController.h"
+#include "AIVisibilitySubsystem.h"
+#include "AISignificanceSubsystem.h"
+#include "ShooterAIController.h"
+#include "ShooterTemplate.h"
 #include "BehaviorTree/BlackboardComponent.h"
-#include "Kismet/GameplayStatics.h"
 
 UBTService_PlayerLocationIfSeen::UBTService_PlayerLocationIfSeen()
 {
@@ -14,25 +17,52 @@ UBTService_PlayerLocationIfSeen::UBTService_PlayerLocationIfSeen()
 
 void UBTService_PlayerLocationIfSeen::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
 {
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterBTServices);
 	Super::TickNode(OwnerComp, NodeMemory, DeltaSeconds);
 
-	APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(GetWorld(), 0);
-	if (PlayerPawn == nullptr)
+	// Less significant AI run this service less often
+	if (const UAISignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UAISignificanceSubsystem>())
 	{
-		return;
+		const float IntervalScale = Significance->GetServiceIntervalScale(OwnerComp.GetAIOwner());
+		SetNextTickTime(NodeMemory, GetNextTickRemainingTime(NodeMemory) * IntervalScale);
 	}
-	
-	if (OwnerComp.GetAIOwner() == nullptr)
+
+	// The pairs asked about have to outlive the wait until the next tick, however long it was scaled to
+	const float NextTickTime = GetNextTickRemainingTime(NodeMemory);
+
+	AShooterAIController* Controller = Cast<AShooterAIController>(OwnerComp.GetAIOwner());
+	UAIVisibilitySubsystem* Visibility = GetWorld()->GetSubsystem<UAIVisibilitySubsystem>();
+	if (Controller == nullptr || Visibility == nullptr)
 	{
 		return;
 	}
 
-	if (OwnerComp.GetAIOwner()->LineOfSightTo(PlayerPawn))
+	TArray<AActor*> Targets;
+	Controller->FindTargets(MaxTargets, Targets);
+
+	// Cached results, refreshed by the visibility subsystem. The nearest player in sight wins. Keep the
+	// old value until there is a fresh result for one of them
+	bool bAnyFreshResult = false;
+	for (AActor* Target : Targets)
 	{
-		OwnerComp.GetBlackboardComponent()->
-		          SetValueAsObject(GetSelectedBlackboardKey(), PlayerPawn);
+		bool bCanSeeTarget;
+		float ResultAge;
+		if (!Visibility->GetVisibility(Controller, Target, bCanSeeTarget, ResultAge, NextTickTime) ||
+			ResultAge > MaxResultAge)
+		{
+			continue;
+		}
+
+		bAnyFreshResult = true;
+		if (bCanSeeTarget)
+		{
+			OwnerComp.GetBlackboardComponent()->SetValueAsObject(GetSelectedBlackboardKey(), Target);
+			return;
+		}
 	}
-	else
+
+	// No live player in range is as good as none in sight
+	if (bAnyFreshResult || Targets.Num() == 0)
 	{
 		OwnerComp.GetBlackboardComponent()->ClearValue(GetSelectedBlackboardKey());
 	}
@@ -17,4 +17,12 @@ public:
 	UBTService_PlayerLocationIfSeen();
 protected:
 	virtual void TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+	/** Line of sight results older than this leave the blackboard untouched */
+	UPROPERTY(EditAnywhere, Category = Blackboard)
+	float MaxResultAge = 1.f;
+
+	/** How many of the nearest players are checked for line of sight, nearest first */
+	UPROPERTY(EditAnywhere, Category = Blackboard)
+	int32 MaxTargets = 4;
 };
@@ -0,0 +1,252 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BakeVisibilityGridCommandlet.h"
+
+#include "VisibilityGrid.h"
+#include "Async/ParallelFor.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/FileManager.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Math/RandomStream.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+
+UBakeVisibilityGridCommandlet::UBakeVisibilityGridCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UBakeVisibilityGridCommandlet::Main(const FString& Params)
+{
+	FString MapName = TEXT("/Game/_Game/Maps/Sandbox");
+	float CellSize = 400.f;
+	float MaxDistance = 8000.f;
+	int32 MaxCells = 32768;
+	FParse::Value(*Params, TEXT("Map="), MapName);
+	FParse::Value(*Params, TEXT("CellSize="), CellSize);
+	FParse::Value(*Params, TEXT("MaxDistance="), MaxDistance);
+	FParse::Value(*Params, TEXT("MaxCells="), MaxCells);
+
+	const double StartTime = FPlatformTime::Seconds();
+	UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (World == nullptr || CellSize <= 0.f)
+	{
+		UE_LOG(LogTemp, Error, TEXT("BakeVisibilityGrid: can't load map %s"), *MapName);
+		return 1;
+	}
+
+	// Only collision is needed to trace against the level
+	World->WorldType = EWorldType::Editor;
+	World->AddToRoot();
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+		                 .AllowAudioPlayback(false)
+		                 .RequiresHitProxies(false)
+		                 .CreatePhysicsScene(true)
+		                 .CreateNavigation(false)
+		                 .CreateAISystem(false)
+		                 .ShouldSimulatePhysics(false)
+		                 .EnableTraceCollision(true));
+	}
+	World->UpdateWorldComponents(true, false);
+
+	// Bounds of the static geometry that blocks sight. Movable occluders are handled at runtime
+	FBox Bounds(ForceInit);
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		for (const UActorComponent* Component : It->GetComponents())
+		{
+			const UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Component);
+			if (Primitive && Primitive->Mobility == EComponentMobility::Static && Primitive->IsCollisionEnabled() &&
+				Primitive->GetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility) == ECR_Block)
+			{
+				Bounds += Primitive->Bounds.GetBox();
+			}
+		}
+	}
+	if (!Bounds.IsValid)
+	{
+		UE_LOG(LogTemp, Error, TEXT("BakeVisibilityGrid: %s has no static geometry"), *MapName);
+		World->RemoveFromRoot();
+		return 1;
+	}
+
+	// Coarser cells rather than a grid that can't be baked in reasonable time
+	FIntVector Size;
+	for (;;)
+	{
+		const FVector Cells = Bounds.GetSize() / CellSize;
+		Size = FIntVector(FMath::CeilToInt(Cells.X), FMath::CeilToInt(Cells.Y), FMath::CeilToInt(Cells.Z));
+		Size = FIntVector(FMath::Max(Size.X, 1), FMath::Max(Size.Y, 1), FMath::Max(Size.Z, 1));
+		if (static_cast<int64>(Size.X) * Size.Y * Size.Z <= MaxCells)
+		{
+			break;
+		}
+		CellSize *= 1.25f;
+	}
+	const int32 NumCells = Size.X * Size.Y * Size.Z;
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(BakeVisibilityGrid), true);
+	const FCollisionShape CellProbe = FCollisionShape::MakeSphere(CellSize * 0.25f);
+
+	// Cells whose middle is inside geometry have no visibility bits
+	TArray<int32> OpenIndices;
+	OpenIndices.Init(INDEX_NONE, NumCells);
+	TArray<FVector> OpenCenters;
+	for (int32 Z = 0; Z < Size.Z; ++Z)
+	{
+		for (int32 Y = 0; Y < Size.Y; ++Y)
+		{
+			for (int32 X = 0; X < Size.X; ++X)
+			{
+				const FVector Center = Bounds.Min + (FVector(X, Y, Z) + 0.5f) * CellSize;
+				if (!World->OverlapBlockingTestByChannel(Center, FQuat::Identity, ECollisionChannel::ECC_Visibility,
+				                                         CellProbe, QueryParams))
+				{
+					OpenIndices[(Z * Size.Y + Y) * Size.X + X] = OpenCenters.Num();
+					OpenCenters.Add(Center);
+				}
+			}
+		}
+	}
+	const int32 NumOpenCells = OpenCenters.Num();
+
+	// A pair is visible if any of these rays between the two cells is clear
+	const float SampleOffset = CellSize * 0.25f;
+	const FVector SampleOffsets[] = {
+		FVector::ZeroVector,
+		FVector(SampleOffset, SampleOffset, SampleOffset),
+		FVector(-SampleOffset, -SampleOffset, SampleOffset),
+		FVector(SampleOffset, -SampleOffset, -SampleOffset),
+		FVector(-SampleOffset, SampleOffset, -SampleOffset)
+	};
+	const float MaxDistanceSquared = FMath::Square(MaxDistance);
+
+	// One bit array per row of the upper triangle, so rows can be traced in parallel
+	TArray<TBitArray<>> Rows;
+	Rows.SetNum(NumOpenCells);
+	FThreadSafeCounter64 NumTraces;
+	ParallelFor(NumOpenCells, [&](int32 Low)
+	{
+		TBitArray<>& Row = Rows[Low];
+		Row.Init(false, NumOpenCells - Low);
+		Row[0] = true;
+		int64 RowTraces = 0;
+		for (int32 High = Low + 1; High < NumOpenCells; ++High)
+		{
+			const FVector& From = OpenCenters[Low];
+			const FVector& To = OpenCenters[High];
+			if (FVector::DistSquared(From, To) > MaxDistanceSquared)
+			{
+				continue;
+			}
+			for (const FVector& Offset : SampleOffsets)
+			{
+				++RowTraces;
+				if (!World->LineTraceTestByChannel(From + Offset, To + Offset, ECollisionChannel::ECC_Visibility,
+				                                   QueryParams))
+				{
+					Row[High - Low] = true;
+					break;
+				}
+			}
+		}
+		NumTraces.Add(RowTraces);
+	});
+
+	TArray<uint8> PairBits;
+	PairBits.SetNumZeroed(FVisibilityGrid::NumPairBytes(NumOpenCells));
+	for (int32 Low = 0; Low < NumOpenCells; ++Low)
+	{
+		const uint64 RowStart = FVisibilityGrid::PairBitIndex(Low, Low, NumOpenCells);
+		for (TConstSetBitIterator<> It(Rows[Low]); It; ++It)
+		{
+			const uint64 Bit = RowStart + It.GetIndex();
+			PairBits[Bit >> 3] |= 1 << (Bit & 7);
+		}
+	}
+	Rows.Empty();
+
+	FVisibilityGridHeader Header;
+	Header.OriginX = Bounds.Min.X;
+	Header.OriginY = Bounds.Min.Y;
+	Header.OriginZ = Bounds.Min.Z;
+	Header.CellSize = CellSize;
+	Header.SizeX = Size.X;
+	Header.SizeY = Size.Y;
+	Header.SizeZ = Size.Z;
+	Header.MaxDistance = MaxDistance;
+	Header.NumOpenCells = NumOpenCells;
+
+	const FString Filename = FPaths::ProjectContentDir() / TEXT("VisibilityGrids") /
+		FPackageName::GetShortName(MapName) + TEXT(".pvs");
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Writer)
+	{
+		UE_LOG(LogTemp, Error, TEXT("BakeVisibilityGrid: can't write %s"), *Filename);
+		World->RemoveFromRoot();
+		return 1;
+	}
+	Writer->Serialize(&Header, sizeof(Header));
+	Writer->Serialize(OpenIndices.GetData(), OpenIndices.Num() * sizeof(int32));
+	Writer->Serialize(PairBits.GetData(), PairBits.Num());
+	Writer->Close();
+	const double BakeSeconds = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogTemp, Display, TEXT("BakeVisibilityGrid: %s, %dx%dx%d cells of %.0f, %d open, %lld traces"),
+	       *MapName, Size.X, Size.Y, Size.Z, CellSize, NumOpenCells, NumTraces.GetValue());
+	UE_LOG(LogTemp, Display, TEXT("BakeVisibilityGrid: baked in %.1f s, %s is %.1f KB"),
+	       BakeSeconds, *Filename, FVisibilityGrid::FileSize(NumCells, NumOpenCells) / 1024.0);
+
+	// Compare a grid lookup with the trace it replaces, on random points within the baked distance
+	FVisibilityGrid Grid;
+	if (NumOpenCells > 1 && Grid.Load(Filename))
+	{
+		FRandomStream Random(NumOpenCells);
+		TArray<TPair<FVector, FVector>> Samples;
+		while (Samples.Num() < 10000)
+		{
+			const FVector From = OpenCenters[Random.RandHelper(NumOpenCells)] + Random.GetUnitVector() * SampleOffset;
+			const FVector To = OpenCenters[Random.RandHelper(NumOpenCells)] + Random.GetUnitVector() * SampleOffset;
+			if (FVector::DistSquared(From, To) <= MaxDistanceSquared)
+			{
+				Samples.Emplace(From, To);
+			}
+		}
+
+		int32 NumAgreed = 0;
+		TArray<bool> GridVisible;
+		GridVisible.SetNumUninitialized(Samples.Num());
+		const double GridStart = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < Samples.Num(); ++Index)
+		{
+			GridVisible[Index] = Grid.Query(Samples[Index].Key, Samples[Index].Value) != EVisibilityGridResult::Hidden;
+		}
+		const double GridSeconds = FPlatformTime::Seconds() - GridStart;
+
+		const double TraceStart = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < Samples.Num(); ++Index)
+		{
+			const bool bTraceVisible = !World->LineTraceTestByChannel(Samples[Index].Key, Samples[Index].Value,
+			                                                          ECollisionChannel::ECC_Visibility, QueryParams);
+			NumAgreed += bTraceVisible == GridVisible[Index];
+		}
+		const double TraceSeconds = FPlatformTime::Seconds() - TraceStart;
+
+		UE_LOG(LogTemp, Display,
+		       TEXT("BakeVisibilityGrid: lookup %.3f us, trace %.3f us, %.0fx faster, agrees with the trace %.1f%%"),
+		       GridSeconds * 1e6 / Samples.Num(), TraceSeconds * 1e6 / Samples.Num(),
+		       TraceSeconds / FMath::Max(GridSeconds, 1e-9), 100.0 * NumAgreed / Samples.Num());
+	}
+
+	World->RemoveFromRoot();
+	return 0;
+}
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "BakeVisibilityGridCommandlet.generated.h"
+
+/**
+ * Bakes the AI visibility grid of a map. The static geometry's bounds are cut into cells, cells inside
+ * geometry are dropped, and every pair of open cells within MaxDistance is traced on the Visibility
+ * channel. The result goes to Content/VisibilityGrids/<Map>.pvs, where UAIVisibilitySubsystem maps it.
+ *
+ * UE4Editor-Cmd ShooterTemplate -run=BakeVisibilityGrid [-Map=/Game/_Game/Maps/Sandbox] [-CellSize=400]
+ *     [-MaxDistance=8000] [-MaxCells=32768]
+ */
+UCLASS()
+class SHOOTERTEMPLATE_API UBakeVisibilityGridCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UBakeVisibilityGridCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,413 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CrowdSubsystem.h"
+
+#include "DamageQueueSubsystem.h"
+#include "PawnPoolSubsystem.h"
+#include "ShooterCharacter.h"
+#include "ShooterTemplate.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PlayerController.h"
+
+static FAutoConsoleCommandWithWorld CrowdStatsCommand(
+	TEXT("Shooter.Crowd.Stats"),
+	TEXT("Log how many crowd agents are live and how many are promoted to actors."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		const UCrowdSubsystem* Crowd = World ? World->GetSubsystem<UCrowdSubsystem>() : nullptr;
+		if (Crowd)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Crowd: %d agents, %d promoted"), Crowd->GetNumAgents(), Crowd->GetNumPromoted());
+		}
+	}));
+
+void UCrowdSubsystem::Deinitialize()
+{
+	// The world is going away with the promoted actors in it, so only the fragments need clearing
+	Ids.Reset();
+	Locations.Reset();
+	Yaws.Reset();
+	Healths.Reset();
+	Targets.Reset();
+	States.Reset();
+	Actors.Reset();
+	AgentClasses.Reset();
+	IndexById.Reset();
+	NumPromoted = 0;
+	NumDead = 0;
+	Super::Deinitialize();
+}
+
+int32 UCrowdSubsystem::SpawnAgent(TSubclassOf<AShooterCharacter> AgentClass, const FTransform& Transform)
+{
+	if (AgentClass == nullptr || Ids.Num() >= MaxAgents)
+	{
+		return INDEX_NONE;
+	}
+
+	if (Ids.Num() == 0)
+	{
+		Ids.Reserve(MaxAgents);
+		Locations.Reserve(MaxAgents);
+		Yaws.Reserve(MaxAgents);
+		Healths.Reserve(MaxAgents);
+		Targets.Reserve(MaxAgents);
+		States.Reserve(MaxAgents);
+		Actors.Reserve(MaxAgents);
+		AgentClasses.Reserve(MaxAgents);
+		NearestDistancesSquared.Reserve(MaxAgents);
+	}
+
+	const int32 AgentId = NextAgentId++;
+	IndexById.Add(AgentId, Ids.Num());
+	Ids.Add(AgentId);
+	Locations.Add(Transform.GetLocation());
+	Yaws.Add(Transform.Rotator().Yaw);
+	Healths.Add(AgentClass.GetDefaultObject()->GetMaxHealth());
+	Targets.Add(INDEX_NONE);
+	States.Add(ECrowdAgentState::Idle);
+	Actors.AddDefaulted();
+	AgentClasses.Add(AgentClass);
+	return AgentId;
+}
+
+void UCrowdSubsystem::ClearAgents()
+{
+	for (int32 Index = Ids.Num() - 1; Index >= 0; --Index)
+	{
+		if (AShooterCharacter* Character = Actors[Index].Get())
+		{
+			AController* Controller = Character->GetController();
+			Character->Destroy();
+			if (Controller)
+			{
+				Controller->Destroy();
+			}
+		}
+		RemoveAgent(Index);
+	}
+	NumPromoted = 0;
+}
+
+float UCrowdSubsystem::ApplyDamageToAgent(int32 AgentId, float DamageAmount, AController* EventInstigator,
+                                          AActor* DamageCauser)
+{
+	const int32* Index = IndexById.Find(AgentId);
+	if (Index == nullptr || States[*Index] == ECrowdAgentState::Dead || DamageAmount <= 0.f)
+	{
+		return 0.f;
+	}
+
+	// The actor owns the health while promoted, and is synced back before demotion
+	if (AShooterCharacter* Character = Actors[*Index].Get())
+	{
+		return Character->TakeDamage(DamageAmount, FDamageEvent(), EventInstigator, DamageCauser);
+	}
+
+	UDamageQueueSubsystem* DamageQueue = GetWorld()->GetSubsystem<UDamageQueueSubsystem>();
+	if (DamageQueue == nullptr)
+	{
+		return 0.f;
+	}
+	DamageQueue->QueueAgentDamage(AgentId, DamageAmount, EventInstigator, DamageCauser);
+	return DamageAmount;
+}
+
+bool UCrowdSubsystem::RaycastFragments(const FVector& Start, const FVector& End, int32& OutAgentId,
+                                       FVector& OutLocation) const
+{
+	const FVector HalfSegment(0.f, 0.f, FMath::Max(AgentHalfHeight - AgentRadius, 0.f));
+	const float RadiusSquared = FMath::Square(AgentRadius);
+	float NearestDistanceSquared = MAX_flt;
+	for (int32 Index = 0; Index < Ids.Num(); ++Index)
+	{
+		if (!IsLiveFragment(Index))
+		{
+			continue;
+		}
+
+		FVector OnRay;
+		FVector OnAgent;
+		FMath::SegmentDistToSegmentSafe(Start, End, Locations[Index] - HalfSegment, Locations[Index] + HalfSegment,
+		                                OnRay, OnAgent);
+		const float DistanceSquared = FVector::DistSquared(Start, OnRay);
+		if (FVector::DistSquared(OnRay, OnAgent) <= RadiusSquared && DistanceSquared < NearestDistanceSquared)
+		{
+			NearestDistanceSquared = DistanceSquared;
+			OutAgentId = Ids[Index];
+			OutLocation = OnRay;
+		}
+	}
+	return NearestDistanceSquared < MAX_flt;
+}
+
+void UCrowdSubsystem::QueryFragments(const FVector& Origin, float Radius, TArray<int32>& OutAgentIds,
+                                     TArray<FVector>& OutLocations) const
+{
+	const float RadiusSquared = FMath::Square(Radius);
+	for (int32 Index = 0; Index < Ids.Num(); ++Index)
+	{
+		if (IsLiveFragment(Index) && FVector::DistSquared(Origin, Locations[Index]) < RadiusSquared)
+		{
+			OutAgentIds.Add(Ids[Index]);
+			OutLocations.Add(Locations[Index]);
+		}
+	}
+}
+
+float UCrowdSubsystem::ResolveFragmentHit(int32 AgentId, float DamageAmount, AController* EventInstigator,
+                                          AActor* DamageCauser, bool& bOutKilled)
+{
+	bOutKilled = false;
+	const int32* Index = IndexById.Find(AgentId);
+	if (Index == nullptr || States[*Index] == ECrowdAgentState::Dead || Healths[*Index] <= 0.f)
+	{
+		return 0.f;
+	}
+
+	// Promoted after the hit was queued. The actor's health component takes it on the next resolve
+	if (AShooterCharacter* Character = Actors[*Index].Get())
+	{
+		Character->TakeDamage(DamageAmount, FDamageEvent(), EventInstigator, DamageCauser);
+		return 0.f;
+	}
+
+	const float DamageToApply = FMath::Min(Healths[*Index], DamageAmount);
+	Healths[*Index] -= DamageToApply;
+	bOutKilled = Healths[*Index] <= 0.f;
+	return DamageToApply;
+}
+
+void UCrowdSubsystem::KillFragment(int32 AgentId)
+{
+	const int32* Index = IndexById.Find(AgentId);
+	if (Index == nullptr || States[*Index] == ECrowdAgentState::Dead)
+	{
+		return;
+	}
+
+	// Counted as dead before the broadcast, so the game mode sees it gone. Removed at the end of the next tick
+	States[*Index] = ECrowdAgentState::Dead;
+	++NumDead;
+	OnAgentKilled.Broadcast(AgentId);
+}
+
+bool UCrowdSubsystem::IsLiveFragment(int32 Index) const
+{
+	const ECrowdAgentState State = States[Index];
+	return State != ECrowdAgentState::Promoted && State != ECrowdAgentState::Dead && Healths[Index] > 0.f;
+}
+
+float UCrowdSubsystem::GetAgentHealth(int32 AgentId) const
+{
+	const int32* Index = IndexById.Find(AgentId);
+	if (Index == nullptr)
+	{
+		return 0.f;
+	}
+	const AShooterCharacter* Character = Actors[*Index].Get();
+	return Character ? Character->GetHealth() : Healths[*Index];
+}
+
+void UCrowdSubsystem::Tick(float DeltaTime)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterCrowd);
+	SyncPromoted();
+
+	TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		const APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+		if (Pawn)
+		{
+			PlayerLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+
+	RunProcessors(DeltaTime, PlayerLocations);
+	UpdatePromotion();
+
+	for (int32 Index = Ids.Num() - 1; Index >= 0; --Index)
+	{
+		if (States[Index] == ECrowdAgentState::Dead)
+		{
+			RemoveAgent(Index);
+		}
+	}
+}
+
+bool UCrowdSubsystem::IsTickable() const
+{
+	return !IsTemplate() && Ids.Num() > 0 && !GetWorld()->IsNetMode(NM_Client);
+}
+
+TStatId UCrowdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCrowdSubsystem, STATGROUP_Tickables);
+}
+
+void UCrowdSubsystem::SyncPromoted()
+{
+	for (int32 Index = 0; Index < Ids.Num(); ++Index)
+	{
+		if (States[Index] != ECrowdAgentState::Promoted)
+		{
+			continue;
+		}
+
+		const AShooterCharacter* Character = Actors[Index].Get();
+		if (Character == nullptr || Character->IsDead())
+		{
+			// Killed in the damage queue, which already told the game mode and gave the corpse to the pawn pool
+			Healths[Index] = 0.f;
+			States[Index] = ECrowdAgentState::Dead;
+			Actors[Index].Reset();
+			--NumPromoted;
+			++NumDead;
+			continue;
+		}
+
+		Locations[Index] = Character->GetActorLocation();
+		Yaws[Index] = Character->GetActorRotation().Yaw;
+		Healths[Index] = Character->GetHealth();
+	}
+}
+
+void UCrowdSubsystem::RunProcessors(float DeltaTime, TArrayView<const FVector> PlayerLocations)
+{
+	NearestDistancesSquared.SetNumUninitialized(Ids.Num(), false);
+
+	const float AggroRangeSquared = FMath::Square(AggroRange);
+	const float StepDistance = MoveSpeed * DeltaTime;
+
+	ParallelFor(Ids.Num(), [this, PlayerLocations, AggroRangeSquared, StepDistance](int32 Index)
+	{
+		// Target selection. Promoted agents need the distance too, to decide on demotion
+		float NearestDistanceSquared = MAX_flt;
+		int32 Target = INDEX_NONE;
+		for (int32 Player = 0; Player < PlayerLocations.Num(); ++Player)
+		{
+			const float DistanceSquared = FVector::DistSquared(Locations[Index], PlayerLocations[Player]);
+			if (DistanceSquared < NearestDistanceSquared)
+			{
+				NearestDistanceSquared = DistanceSquared;
+				Target = Player;
+			}
+		}
+		NearestDistancesSquared[Index] = NearestDistanceSquared;
+		Targets[Index] = Target;
+
+		const ECrowdAgentState State = States[Index];
+		if (State == ECrowdAgentState::Promoted || State == ECrowdAgentState::Dead)
+		{
+			return;
+		}
+
+		// Movement. Straight at the target on the ground plane, stopping at attack range
+		if (Target == INDEX_NONE || NearestDistanceSquared > AggroRangeSquared)
+		{
+			States[Index] = ECrowdAgentState::Idle;
+			return;
+		}
+
+		const FVector ToTarget = (PlayerLocations[Target] - Locations[Index]) * FVector(1.f, 1.f, 0.f);
+		const float Distance = ToTarget.Size();
+		if (Distance <= AttackRange)
+		{
+			States[Index] = ECrowdAgentState::Attacking;
+			return;
+		}
+
+		const FVector Direction = ToTarget / Distance;
+		Locations[Index] += Direction * FMath::Min(StepDistance, Distance - AttackRange);
+		Yaws[Index] = Direction.Rotation().Yaw;
+		States[Index] = ECrowdAgentState::Chasing;
+	});
+}
+
+void UCrowdSubsystem::UpdatePromotion()
+{
+	const float PromoteDistanceSquared = FMath::Square(PromoteDistance);
+	const float DemoteDistanceSquared = FMath::Square(DemoteDistance);
+
+	int32 Promotions = 0;
+	for (int32 Index = 0; Index < Ids.Num(); ++Index)
+	{
+		const ECrowdAgentState State = States[Index];
+		if (State == ECrowdAgentState::Promoted)
+		{
+			if (NearestDistancesSquared[Index] > DemoteDistanceSquared)
+			{
+				Demote(Index);
+			}
+		}
+		else if (State != ECrowdAgentState::Dead && Promotions < MaxPromotionsPerFrame &&
+			NearestDistancesSquared[Index] < PromoteDistanceSquared)
+		{
+			Promote(Index);
+			++Promotions;
+		}
+	}
+}
+
+void UCrowdSubsystem::Promote(int32 Index)
+{
+	UPawnPoolSubsystem* PawnPool = GetWorld()->GetSubsystem<UPawnPoolSubsystem>();
+	const FTransform Transform(FRotator(0.f, Yaws[Index], 0.f), Locations[Index]);
+	AShooterCharacter* Character = PawnPool ? PawnPool->AcquireCharacter(AgentClasses[Index], Transform) : nullptr;
+	if (Character == nullptr)
+	{
+		// Tried again next frame
+		return;
+	}
+	Character->SetHealth(Healths[Index]);
+
+	Actors[Index] = Character;
+	States[Index] = ECrowdAgentState::Promoted;
+	++NumPromoted;
+}
+
+void UCrowdSubsystem::Demote(int32 Index)
+{
+	AShooterCharacter* Character = Actors[Index].Get();
+	Locations[Index] = Character->GetActorLocation();
+	Yaws[Index] = Character->GetActorRotation().Yaw;
+	Healths[Index] = Character->GetHealth();
+
+	// Goes dormant with its controller until an agent of the same class is promoted
+	if (UPawnPoolSubsystem* PawnPool = GetWorld()->GetSubsystem<UPawnPoolSubsystem>())
+	{
+		PawnPool->ReleaseCharacter(Character, false);
+	}
+
+	Actors[Index].Reset();
+	States[Index] = ECrowdAgentState::Idle;
+	--NumPromoted;
+}
+
+void UCrowdSubsystem::RemoveAgent(int32 Index)
+{
+	if (States[Index] == ECrowdAgentState::Dead)
+	{
+		--NumDead;
+	}
+	IndexById.Remove(Ids[Index]);
+	Ids.RemoveAtSwap(Index, 1, false);
+	Locations.RemoveAtSwap(Index, 1, false);
+	Yaws.RemoveAtSwap(Index, 1, false);
+	Healths.RemoveAtSwap(Index, 1, false);
+	Targets.RemoveAtSwap(Index, 1, false);
+	States.RemoveAtSwap(Index, 1, false);
+	Actors.RemoveAtSwap(Index, 1, false);
+	AgentClasses.RemoveAtSwap(Index, 1, false);
+
+	// The last agent took the removed one's place
+	if (Ids.IsValidIndex(Index))
+	{
+		IndexById.Add(Ids[Index], Index);
+	}
+}
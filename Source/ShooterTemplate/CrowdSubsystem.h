@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "CrowdSubsystem.generated.h"
+
+class AShooterCharacter;
+
+/** What a crowd agent is doing this frame */
+UENUM()
+enum class ECrowdAgentState : uint8
+{
+	Idle,
+	Chasing,
+	Attacking,
+	/** Lives as a full actor, the fragments only mirror it */
+	Promoted,
+	Dead
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnCrowdAgentKilled, int32 /*AgentId*/);
+
+/**
+ * Crowd mode for large numbers of enemies. Agents far from every player are just entries in contiguous
+ * fragment arrays (transform, health, target, state) run by batched processors with a ParallelFor. An
+ * agent that comes within PromoteDistance of a player is spawned as its full AShooterCharacter with an AI
+ * controller, and goes back to fragments past DemoteDistance. Health moves with the agent both ways.
+ * Fragment agents are upright capsules to hitscan shots and radial damage, and their hits are resolved by
+ * the damage queue with every other hit of the frame, so they die in its death phase. Server only.
+ */
+UCLASS(Config = Game)
+class SHOOTERTEMPLATE_API UCrowdSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+public:
+	virtual void Deinitialize() override;
+
+	/**
+	 * Add an agent that is promoted to AgentClass near players
+	 * @return id of the new agent, INDEX_NONE if MaxAgents are already live
+	 */
+	UFUNCTION(BlueprintCallable, Category = Crowd)
+	int32 SpawnAgent(TSubclassOf<AShooterCharacter> AgentClass, const FTransform& Transform);
+
+	/** Remove every agent, destroying the promoted ones */
+	UFUNCTION(BlueprintCallable, Category = Crowd)
+	void ClearAgents();
+
+	/**
+	 * Damage an agent through the damage queue. Promoted agents take it through their actor's TakeDamage
+	 * @return damage queued
+	 */
+	float ApplyDamageToAgent(int32 AgentId, float DamageAmount, AController* EventInstigator, AActor* DamageCauser);
+
+	/** Nearest live fragment agent along the segment. Game thread only */
+	bool RaycastFragments(const FVector& Start, const FVector& End, int32& OutAgentId, FVector& OutLocation) const;
+
+	/** Live fragment agents within Radius of Origin, and their locations at the same index. Game thread only */
+	void QueryFragments(const FVector& Origin, float Radius, TArray<int32>& OutAgentIds,
+	                    TArray<FVector>& OutLocations) const;
+
+	/** Health of an agent, promoted or not. Zero for unknown agents */
+	float GetAgentHealth(int32 AgentId) const;
+
+	FORCEINLINE int32 GetNumAgents() const { return Ids.Num(); }
+	FORCEINLINE int32 GetNumPromoted() const { return NumPromoted; }
+
+	/** Agents that are alive and not promoted to actors */
+	FORCEINLINE int32 GetNumAliveFragments() const { return Ids.Num() - NumPromoted - NumDead; }
+
+	/** Broadcast when a fragment agent dies. Promoted agents report through the game mode like any pawn */
+	FOnCrowdAgentKilled OnAgentKilled;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+private:
+	/** Resolves fragment agents' hits */
+	friend class UDamageQueueSubsystem;
+
+	/**
+	 * Apply one of the damage queue's hits to a fragment agent, clamped to its health. A hit on an agent
+	 * promoted since it was queued goes to the actor instead
+	 * @return damage applied to the fragment
+	 */
+	float ResolveFragmentHit(int32 AgentId, float DamageAmount, AController* EventInstigator, AActor* DamageCauser,
+	                         bool& bOutKilled);
+
+	/** From the damage queue's death phase, for a fragment agent its hits killed */
+	void KillFragment(int32 AgentId);
+
+	/** True if the agent at Index is a fragment that can still be hit */
+	bool IsLiveFragment(int32 Index) const;
+
+	/** Copy promoted actors back into their fragments, and drop the ones that died or went away */
+	void SyncPromoted();
+
+	/** Pick the nearest player and move toward it. Runs across worker threads */
+	void RunProcessors(float DeltaTime, TArrayView<const FVector> PlayerLocations);
+
+	/** Promote agents that came near a player and demote the ones that moved away */
+	void UpdatePromotion();
+
+	void Promote(int32 Index);
+	void Demote(int32 Index);
+	void RemoveAgent(int32 Index);
+
+	/** Agents within this distance of a player are promoted to actors */
+	UPROPERTY(Config)
+	float PromoteDistance{3000.f};
+
+	/** Promoted agents further than this from every player are demoted. Above PromoteDistance to avoid thrashing */
+	UPROPERTY(Config)
+	float DemoteDistance{4000.f};
+
+	/** Spawning a character is expensive, so promotions are spread over frames */
+	UPROPERTY(Config)
+	int32 MaxPromotionsPerFrame{2};
+
+	/** Fragment agents start chasing players within this distance */
+	UPROPERTY(Config)
+	float AggroRange{8000.f};
+
+	/** Fragment agents stop this far from their target */
+	UPROPERTY(Config)
+	float AttackRange{1000.f};
+
+	/** Speed of fragment agents. Matches the character's walk speed */
+	UPROPERTY(Config)
+	float MoveSpeed{160.f};
+
+	/** Capsule fragment agents are hit on. Matches the character's capsule */
+	UPROPERTY(Config)
+	float AgentRadius{34.f};
+
+	UPROPERTY(Config)
+	float AgentHalfHeight{88.f};
+
+	/** Buffers are reserved for this many agents up front */
+	UPROPERTY(Config)
+	int32 MaxAgents{1024};
+
+	/** Fragments, one entry per array at the same index */
+	TArray<int32> Ids;
+	TArray<FVector> Locations;
+	TArray<float> Yaws;
+	TArray<float> Healths;
+	TArray<int32> Targets;
+	TArray<ECrowdAgentState> States;
+	TArray<TWeakObjectPtr<AShooterCharacter>> Actors;
+
+	UPROPERTY(Transient)
+	TArray<TSubclassOf<AShooterCharacter>> AgentClasses;
+
+	/** Per-frame scratch filled by the processors */
+	TArray<float> NearestDistancesSquared;
+
+	TMap<int32, int32> IndexById;
+	int32 NextAgentId{0};
+	int32 NumPromoted{0};
+
+	/** Dead agents waiting to be removed at the end of the tick */
+	int32 NumDead{0};
+};
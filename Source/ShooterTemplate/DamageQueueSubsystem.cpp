@@ -0,0 +1,229 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DamageQueueSubsystem.h"
+
+#include "CrowdSubsystem.h"
+#include "GameplayEventBus.h"
+#include "HealthComponent.h"
+#include "ShooterTemplate.h"
+#include "SpatialHashSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+
+static FAutoConsoleCommandWithWorld DamageQueueStatsCommand(
+	TEXT("Shooter.Damage.Stats"),
+	TEXT("Log how many hits and deaths the damage queue resolved for the current world."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		const UDamageQueueSubsystem* DamageQueue = World ? World->GetSubsystem<UDamageQueueSubsystem>() : nullptr;
+		if (DamageQueue)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Damage queue: %lld hits resolved, %lld deaths"),
+			       DamageQueue->GetNumHitsResolved(), DamageQueue->GetNumDeaths());
+		}
+	}));
+
+void UDamageQueueSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Pending.Reserve(ReservedHits);
+	Resolving.Reserve(ReservedHits);
+}
+
+void UDamageQueueSubsystem::Deinitialize()
+{
+	Pending.Empty();
+	Resolving.Empty();
+	KillingHits.Empty();
+	RadialTargets.Empty();
+	RadialAgentIds.Empty();
+	RadialAgentLocations.Empty();
+	Super::Deinitialize();
+}
+
+void UDamageQueueSubsystem::QueueDamage(UHealthComponent* Target, float DamageAmount, AController* EventInstigator,
+                                        AActor* DamageCauser)
+{
+	check(IsInGameThread());
+	Pending.Add({Target, Target->GetLife(), DamageAmount, EventInstigator, DamageCauser});
+}
+
+void UDamageQueueSubsystem::QueueAgentDamage(int32 AgentId, float DamageAmount, AController* EventInstigator,
+                                             AActor* DamageCauser)
+{
+	check(IsInGameThread());
+	Pending.Add({nullptr, 0, DamageAmount, EventInstigator, DamageCauser, AgentId});
+}
+
+int32 UDamageQueueSubsystem::ApplyRadialDamage(const FVector& Origin, const FRadialDamageParams& Params,
+                                               AController* EventInstigator, AActor* DamageCauser,
+                                               ECollisionChannel OcclusionChannel)
+{
+	const USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>();
+	if (SpatialHash == nullptr || Params.OuterRadius <= 0.f)
+	{
+		return 0;
+	}
+
+	// Same falloff as the engine's radial damage, without it rescaling the damage again. Only what blocks the
+	// channel between the blast and the target shields it
+	auto GetDamageAt = [this, &Origin, &Params, DamageCauser, OcclusionChannel](const FVector& TargetLocation,
+	                                                                           const AActor* Target)
+	{
+		const float Distance = FVector::Dist(Origin, TargetLocation);
+		if (Distance >= Params.OuterRadius)
+		{
+			return 0.f;
+		}
+
+		FCollisionQueryParams OcclusionParams(SCENE_QUERY_STAT(RadialDamageOcclusion), false, DamageCauser);
+		OcclusionParams.AddIgnoredActor(Target);
+		if (GetWorld()->LineTraceTestByChannel(Origin, TargetLocation, OcclusionChannel, OcclusionParams))
+		{
+			return 0.f;
+		}
+		return FMath::Lerp(Params.MinimumDamage, Params.BaseDamage, FMath::Max(Params.GetDamageScale(Distance), 0.f));
+	};
+
+	RadialTargets.Reset();
+	SpatialHash->QueryRadius(Origin, Params.OuterRadius, RadialTargets);
+
+	int32 NumDamaged = 0;
+	for (AActor* Target : RadialTargets)
+	{
+		const float Damage = GetDamageAt(Target->GetActorLocation(), Target);
+		if (Damage > 0.f)
+		{
+			Target->TakeDamage(Damage, FDamageEvent(), EventInstigator, DamageCauser);
+			++NumDamaged;
+		}
+	}
+
+	// Crowd agents that aren't actors aren't in the spatial hash
+	UCrowdSubsystem* Crowd = GetWorld()->GetSubsystem<UCrowdSubsystem>();
+	if (Crowd == nullptr)
+	{
+		return NumDamaged;
+	}
+
+	RadialAgentIds.Reset();
+	RadialAgentLocations.Reset();
+	Crowd->QueryFragments(Origin, Params.OuterRadius, RadialAgentIds, RadialAgentLocations);
+	for (int32 Agent = 0; Agent < RadialAgentIds.Num(); ++Agent)
+	{
+		const float Damage = GetDamageAt(RadialAgentLocations[Agent], nullptr);
+		if (Damage > 0.f)
+		{
+			QueueAgentDamage(RadialAgentIds[Agent], Damage, EventInstigator, DamageCauser);
+			++NumDamaged;
+		}
+	}
+	return NumDamaged;
+}
+
+void UDamageQueueSubsystem::Tick(float DeltaTime)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterDamageResolve);
+	Swap(Pending, Resolving);
+	UGameplayEventBus* EventBus = GetWorld()->GetSubsystem<UGameplayEventBus>();
+	UCrowdSubsystem* Crowd = GetWorld()->GetSubsystem<UCrowdSubsystem>();
+
+	// Apply every hit. A revived target ignores hits from its previous life, a dead one any further hits
+	int32 NumApplied = 0;
+	for (int32 Index = 0; Index < Resolving.Num(); ++Index)
+	{
+		const FQueuedDamage& Hit = Resolving[Index];
+		if (Hit.AgentId != INDEX_NONE)
+		{
+			bool bKilled = false;
+			if (Crowd && Crowd->ResolveFragmentHit(Hit.AgentId, Hit.Damage, Hit.Instigator.Get(),
+			                                       Hit.DamageCauser.Get(), bKilled) > 0.f)
+			{
+				++NumApplied;
+				if (bKilled)
+				{
+					KillingHits.Add(Index);
+				}
+			}
+			continue;
+		}
+
+		UHealthComponent* Target = Hit.Target.Get();
+		if (Target == nullptr || Target->Life != Hit.Life || Target->IsDead())
+		{
+			continue;
+		}
+
+		const float DamageToApply = FMath::Min(Target->Health, Hit.Damage);
+		Target->Health -= DamageToApply;
+		++NumApplied;
+		if (Target->IsDead())
+		{
+			KillingHits.Add(Index);
+		}
+
+		// Scoring, HUD, telemetry and audio listen on the bus
+		if (EventBus)
+		{
+			FShooterDamageEvent DamageTaken;
+			DamageTaken.Victim = Target->GetOwner();
+			DamageTaken.Instigator = Hit.Instigator;
+			DamageTaken.DamageCauser = Hit.DamageCauser;
+			DamageTaken.Damage = DamageToApply;
+			DamageTaken.HealthAfter = Target->Health;
+			EventBus->Publish(DamageTaken);
+		}
+	}
+	NumHitsResolved += NumApplied;
+	SHOOTER_INC_COUNTER(STAT_ShooterDamageHits, NumApplied);
+
+	// Death phase, once every hit of the frame is in
+	for (const int32 Index : KillingHits)
+	{
+		const FQueuedDamage& Hit = Resolving[Index];
+		if (Hit.AgentId != INDEX_NONE)
+		{
+			if (Crowd)
+			{
+				Crowd->KillFragment(Hit.AgentId);
+			}
+			continue;
+		}
+
+		UHealthComponent* Target = Hit.Target.Get();
+		if (Target == nullptr)
+		{
+			continue;
+		}
+
+		if (EventBus)
+		{
+			if (APawn* Victim = Cast<APawn>(Target->GetOwner()))
+			{
+				FShooterKillEvent Kill;
+				Kill.Victim = Victim;
+				Kill.Killer = Hit.Instigator;
+				Kill.DamageCauser = Hit.DamageCauser;
+				EventBus->Publish(Kill);
+			}
+		}
+		Target->OnDeath.Broadcast(Target, Hit.Instigator.Get(), Hit.DamageCauser.Get());
+	}
+	NumDeaths += KillingHits.Num();
+	SHOOTER_INC_COUNTER(STAT_ShooterDeaths, KillingHits.Num());
+
+	Resolving.Reset();
+	KillingHits.Reset();
+}
+
+bool UDamageQueueSubsystem::IsTickable() const
+{
+	return !IsTemplate() && Pending.Num() > 0;
+}
+
+TStatId UDamageQueueSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDamageQueueSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "DamageQueueSubsystem.generated.h"
+
+class UHealthComponent;
+struct FRadialDamageParams;
+
+/**
+ * Resolves the frame's damage in one batched pass. Hitscan, projectile, radial and crowd hits only
+ * append to a flat queue as they land. In the tickable object phase every hit is applied in the order
+ * it was queued, clamped to the health left, and damage events go out on the gameplay event bus. Deaths
+ * are collected and processed afterwards in a single phase, so OnDeath handlers, the game mode and the
+ * pawn pool see the frame's final health. The killing hit is the one that took health to zero. Crowd
+ * agents that aren't actors are queued by agent id and resolved against the crowd's health, in the same
+ * order and death phase. They have no actor, so their hits and deaths aren't published on the event bus.
+ */
+UCLASS(Config = Game)
+class SHOOTERTEMPLATE_API UDamageQueueSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Applied on the next resolve. Game thread only */
+	void QueueDamage(UHealthComponent* Target, float DamageAmount, AController* EventInstigator,
+	                 AActor* DamageCauser);
+
+	/** Applied to a crowd agent that isn't an actor on the next resolve. Game thread only */
+	void QueueAgentDamage(int32 AgentId, float DamageAmount, AController* EventInstigator, AActor* DamageCauser);
+
+	/**
+	 * Damage every damageable actor and crowd agent within Params.OuterRadius of Origin, with the params' falloff, unless
+	 * the level blocks OcclusionChannel between them. Each actor's damage is queued like any other hit
+	 * @return how many actors were damaged
+	 */
+	int32 ApplyRadialDamage(const FVector& Origin, const FRadialDamageParams& Params, AController* EventInstigator,
+	                        AActor* DamageCauser, ECollisionChannel OcclusionChannel = ECC_Visibility);
+
+	/** Hits applied and deaths processed since the world started */
+	FORCEINLINE int64 GetNumHitsResolved() const { return NumHitsResolved; }
+	FORCEINLINE int64 GetNumDeaths() const { return NumDeaths; }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+private:
+	struct FQueuedDamage
+	{
+		TWeakObjectPtr<UHealthComponent> Target;
+		uint32 Life;
+		float Damage;
+		TWeakObjectPtr<AController> Instigator;
+		TWeakObjectPtr<AActor> DamageCauser;
+
+		/** Crowd agent hit instead of Target, or INDEX_NONE */
+		int32 AgentId{INDEX_NONE};
+	};
+
+	/** Queues are reserved for this many hits up front */
+	UPROPERTY(Config)
+	int32 ReservedHits{512};
+
+	/** Hits queued since the last resolve */
+	TArray<FQueuedDamage> Pending;
+
+	/** The batch being resolved. Swapped with Pending, so hits queued by death handlers wait a frame */
+	TArray<FQueuedDamage> Resolving;
+
+	/** Indices into Resolving of the hits that killed */
+	TArray<int32> KillingHits;
+
+	/** Actors and crowd agents in range of the current radial damage, reused */
+	TArray<AActor*> RadialTargets;
+	TArray<int32> RadialAgentIds;
+	TArray<FVector> RadialAgentLocations;
+
+	int64 NumHitsResolved{0};
+	int64 NumDeaths{0};
+};
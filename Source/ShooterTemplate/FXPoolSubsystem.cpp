@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FXPoolSubsystem.h"
+
+#include "ShooterTemplate.h"
+#include "Engine/World.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+
+static FAutoConsoleCommandWithWorld FXPoolStatsCommand(
+	TEXT("Shooter.FXPool.Stats"),
+	TEXT("Log the FX pool hit/miss counters for the current world."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		const UFXPoolSubsystem* FXPool = World ? World->GetSubsystem<UFXPoolSubsystem>() : nullptr;
+		if (FXPool)
+		{
+			const FFXPoolStats& Stats = FXPool->GetStats();
+			UE_LOG(LogTemp, Log, TEXT("FX pool: %d hits, %d misses, %d steals, %d drops"),
+			       Stats.Hits, Stats.Misses, Stats.Steals, Stats.Drops);
+		}
+	}));
+
+void UFXPoolSubsystem::PrewarmPool(UParticleSystem* Template)
+{
+	if (Template == nullptr)
+	{
+		return;
+	}
+
+	FFXPool& Pool = Pools.FindOrAdd(Template);
+	while (Pool.Components.Num() < PoolSize)
+	{
+		Pool.Components.Add(CreateComponent(Template));
+	}
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::SpawnAtLocation(UParticleSystem* Template, const FTransform& Transform)
+{
+	UParticleSystemComponent* Component = Acquire(Template);
+	if (Component == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (Component->GetAttachParent())
+	{
+		Component->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+	}
+	Component->SetAbsolute(true, true, true);
+	Component->SetWorldTransform(Transform);
+	Component->ActivateSystem(true);
+	SHOOTER_INC_COUNTER(STAT_ShooterFXSpawns, 1);
+	return Component;
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::SpawnAtLocation(UParticleSystem* Template, const FVector& Location,
+                                                            const FRotator& Rotation)
+{
+	return SpawnAtLocation(Template, FTransform(Rotation, Location));
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::SpawnAttached(UParticleSystem* Template, USceneComponent* AttachToComponent,
+                                                          FName AttachPointName)
+{
+	if (AttachToComponent == nullptr)
+	{
+		return nullptr;
+	}
+
+	UParticleSystemComponent* Component = Acquire(Template);
+	if (Component == nullptr)
+	{
+		return nullptr;
+	}
+
+	Component->SetAbsolute(false, false, false);
+	Component->AttachToComponent(AttachToComponent, FAttachmentTransformRules::KeepRelativeTransform, AttachPointName);
+	Component->SetRelativeTransform(FTransform::Identity);
+	Component->ActivateSystem(true);
+	SHOOTER_INC_COUNTER(STAT_ShooterFXSpawns, 1);
+	return Component;
+}
+
+void UFXPoolSubsystem::DeactivateAll()
+{
+	for (TPair<UParticleSystem*, FFXPool>& Pair : Pools)
+	{
+		for (UParticleSystemComponent* Component : Pair.Value.Components)
+		{
+			if (IsValid(Component))
+			{
+				Component->DeactivateImmediate();
+			}
+		}
+	}
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::Acquire(UParticleSystem* Template)
+{
+	if (Template == nullptr)
+	{
+		return nullptr;
+	}
+
+	FFXPool& Pool = Pools.FindOrAdd(Template);
+	const int32 Num = Pool.Components.Num();
+
+	// Idle component, starting from the oldest slot
+	for (int32 Step = 0; Step < Num; ++Step)
+	{
+		const int32 Index = (Pool.Cursor + Step) % Num;
+		UParticleSystemComponent*& Component = Pool.Components[Index];
+		if (!IsValid(Component))
+		{
+			// Destroyed behind our back, rebuild the slot
+			Component = CreateComponent(Template);
+			++Stats.Misses;
+		}
+		else if (Component->IsActive())
+		{
+			continue;
+		}
+		else
+		{
+			++Stats.Hits;
+		}
+		Pool.Cursor = (Index + 1) % Num;
+		return Component;
+	}
+
+	// Pool not full yet, grow it
+	if (Num < PoolSize)
+	{
+		++Stats.Misses;
+		return Pool.Components.Add_GetRef(CreateComponent(Template));
+	}
+
+	if (OverflowPolicy == EFXPoolOverflowPolicy::Drop || Num == 0)
+	{
+		++Stats.Drops;
+		return nullptr;
+	}
+
+	// Everything is playing, restart the oldest one
+	UParticleSystemComponent* Oldest = Pool.Components[Pool.Cursor];
+	Pool.Cursor = (Pool.Cursor + 1) % Num;
+	Oldest->DeactivateImmediate();
+	++Stats.Steals;
+	return Oldest;
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::CreateComponent(UParticleSystem* Template)
+{
+	// Same setup as UGameplayStatics, minus auto destroy
+	UParticleSystemComponent* Component = NewObject<UParticleSystemComponent>(GetWorld());
+	Component->bAutoDestroy = false;
+	Component->bAllowAnyoneToDestroyMe = true;
+	Component->SecondsBeforeInactive = 0.f;
+	Component->bAutoActivate = false;
+	Component->SetTemplate(Template);
+	Component->bOverrideLODMethod = false;
+	Component->RegisterComponentWithWorld(GetWorld());
+	return Component;
+}
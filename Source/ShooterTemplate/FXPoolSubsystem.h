@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FXPoolSubsystem.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+
+/** What to do when every component in a pool is still playing */
+UENUM()
+enum class EFXPoolOverflowPolicy : uint8
+{
+	/** Restart the component that was handed out longest ago */
+	StealOldest,
+	/** Skip the effect */
+	Drop
+};
+
+/** Fixed-size ring of components for one particle template */
+USTRUCT()
+struct FFXPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<UParticleSystemComponent*> Components;
+
+	/** Next slot to hand out. Slots are handed out in ring order, so this is also the oldest one */
+	int32 Cursor{0};
+};
+
+/** Pool counters since the world started */
+USTRUCT(BlueprintType)
+struct FFXPoolStats
+{
+	GENERATED_BODY()
+
+	/** Requests served by an idle pooled component */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = FX)
+	int32 Hits{0};
+
+	/** Requests that had to construct a new component */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = FX)
+	int32 Misses{0};
+
+	/** Requests served by restarting a component that was still playing */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = FX)
+	int32 Steals{0};
+
+	/** Requests skipped because the pool was full */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = FX)
+	int32 Drops{0};
+};
+
+/**
+ * Hands out particle system components from a pre-warmed ring per template instead of spawning a new
+ * component for every effect. Components are reclaimed as soon as their system finishes playing.
+ */
+UCLASS(Config = Game)
+class SHOOTERTEMPLATE_API UFXPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	/** Construct the full ring for a template up front, so the first shots don't pay for it */
+	void PrewarmPool(UParticleSystem* Template);
+
+	/** Pooled equivalent of UGameplayStatics::SpawnEmitterAtLocation. May return null */
+	UParticleSystemComponent* SpawnAtLocation(UParticleSystem* Template, const FTransform& Transform);
+	UParticleSystemComponent* SpawnAtLocation(UParticleSystem* Template, const FVector& Location,
+	                                          const FRotator& Rotation = FRotator::ZeroRotator);
+
+	/** Pooled equivalent of UGameplayStatics::SpawnEmitterAttached. May return null */
+	UParticleSystemComponent* SpawnAttached(UParticleSystem* Template, USceneComponent* AttachToComponent,
+	                                        FName AttachPointName);
+
+	/** Stop every pooled effect. Components stay in their pools */
+	void DeactivateAll();
+
+	FORCEINLINE const FFXPoolStats& GetStats() const { return Stats; }
+
+private:
+	UParticleSystemComponent* Acquire(UParticleSystem* Template);
+	UParticleSystemComponent* CreateComponent(UParticleSystem* Template);
+
+	UPROPERTY(Transient)
+	TMap<UParticleSystem*, FFXPool> Pools;
+
+	/** Components per template */
+	UPROPERTY(Config)
+	int32 PoolSize{16};
+
+	UPROPERTY(Config)
+	EFXPoolOverflowPolicy OverflowPolicy{EFXPoolOverflowPolicy::StealOldest};
+
+	FFXPoolStats Stats;
+};
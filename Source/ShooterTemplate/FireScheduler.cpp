@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FireScheduler.h"
+
+void FFireScheduler::Configure(EFireMode InFireMode, float RoundsPerMinute, int32 InBurstCount)
+{
+	FireMode = InFireMode;
+	ShotInterval = 60.0 / FMath::Max(RoundsPerMinute, 1.f);
+	BurstCount = FMath::Max(InBurstCount, 1);
+}
+
+void FFireScheduler::PressTrigger(double Time)
+{
+	// A released full auto pull that hasn't been advanced yet ends at its release
+	if (IsFiring() && FireMode == EFireMode::FullAuto && !bTriggerHeld)
+	{
+		ShotsFired = -1;
+	}
+	bTriggerHeld = true;
+
+	// A burst plays out before the next pull is accepted
+	if (IsFiring())
+	{
+		return;
+	}
+
+	FirstShotTime = FMath::Max(Time, NextAllowedShotTime);
+	ShotsFired = 0;
+}
+
+void FFireScheduler::ReleaseTrigger(double Time)
+{
+	bTriggerHeld = false;
+	ReleaseTime = Time;
+}
+
+int32 FFireScheduler::Advance(double Now, TArray<double>& OutShotTimes)
+{
+	if (!IsFiring())
+	{
+		return 0;
+	}
+
+	const int32 ShotLimit = GetShotLimit();
+	int32 NumAdded = 0;
+	while (ShotsFired < ShotLimit)
+	{
+		// Computed from the shot index rather than accumulated, so frame rate can't introduce drift
+		const double ShotTime = FirstShotTime + ShotsFired * ShotInterval;
+
+		// Full auto stops at release. The first shot of a pull always fires
+		if (FireMode == EFireMode::FullAuto && !bTriggerHeld && ShotsFired > 0 && ShotTime > ReleaseTime)
+		{
+			ShotsFired = ShotLimit;
+			break;
+		}
+		if (ShotTime > Now)
+		{
+			break;
+		}
+
+		OutShotTimes.Add(ShotTime);
+		NextAllowedShotTime = ShotTime + ShotInterval;
+		++ShotsFired;
+		++NumAdded;
+	}
+
+	if (ShotsFired >= ShotLimit)
+	{
+		ShotsFired = -1;
+	}
+	return NumAdded;
+}
+
+bool FFireScheduler::IsFiring() const
+{
+	return ShotsFired >= 0;
+}
+
+void FFireScheduler::Reset()
+{
+	bTriggerHeld = false;
+	ShotsFired = -1;
+	NextAllowedShotTime = -DBL_MAX;
+}
+
+int32 FFireScheduler::GetShotLimit() const
+{
+	switch (FireMode)
+	{
+	case EFireMode::Burst:
+		return BurstCount;
+	case EFireMode::FullAuto:
+		return MAX_int32;
+	default:
+		return 1;
+	}
+}
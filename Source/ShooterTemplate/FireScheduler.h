@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FireScheduler.generated.h"
+
+UENUM(BlueprintType)
+enum class EFireMode : uint8
+{
+	/** One shot per trigger pull */
+	SemiAuto,
+	/** BurstCount shots per trigger pull, even if the trigger is released early */
+	Burst,
+	/** Shots for as long as the trigger is held */
+	FullAuto
+};
+
+/**
+ * Works out exactly when each shot happens at a fixed rate of fire, independent of frame rate.
+ * Shot k of a trigger pull is fired at FirstShotTime + k * interval, so the same trigger times always
+ * produce the same shot times whether the scheduler is advanced at 30 or 240 fps. A frame can emit any
+ * number of shots, each with its own timestamp inside the frame.
+ */
+struct SHOOTERTEMPLATE_API FFireScheduler
+{
+	void Configure(EFireMode InFireMode, float RoundsPerMinute, int32 InBurstCount);
+
+	void PressTrigger(double Time);
+	void ReleaseTrigger(double Time);
+
+	/** Append the time of every shot due up to and including Now. Returns the number added */
+	int32 Advance(double Now, TArray<double>& OutShotTimes);
+
+	/** True while shots are still due for the current trigger pull */
+	bool IsFiring() const;
+
+	/** Stop firing and forget the rate of fire cooldown */
+	void Reset();
+
+	FORCEINLINE double GetShotInterval() const { return ShotInterval; }
+
+private:
+	/** Shots allowed for the current trigger pull */
+	int32 GetShotLimit() const;
+
+	EFireMode FireMode{EFireMode::SemiAuto};
+	double ShotInterval{0.1};
+	int32 BurstCount{3};
+
+	bool bTriggerHeld{false};
+	double ReleaseTime{0.0};
+
+	/** Timestamp of shot 0 of the current trigger pull */
+	double FirstShotTime{0.0};
+
+	/** Shots fired so far in the current trigger pull, or -1 when no pull is active */
+	int32 ShotsFired{-1};
+
+	/** The rate of fire holds across trigger pulls: no shot before this time */
+	double NextAllowedShotTime{-DBL_MAX};
+};
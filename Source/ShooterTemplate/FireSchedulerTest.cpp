@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FireScheduler.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace FireSchedulerTest
+{
+	/** A trigger press or release at a time that doesn't line up with any frame */
+	struct FTriggerEvent
+	{
+		double Time;
+		bool bPressed;
+	};
+
+	/**
+	 * Drive a scheduler at a fixed frame time, the way the character does: the frame's trigger events first,
+	 * then one Advance at the end of the frame. Returns every shot time
+	 */
+	TArray<double> Run(EFireMode FireMode, const TArray<FTriggerEvent>& Events, double FrameTime, double Duration)
+	{
+		FFireScheduler Scheduler;
+		Scheduler.Configure(FireMode, 600.f, 3);
+
+		TArray<double> ShotTimes;
+		int32 NextEvent = 0;
+		const int32 NumFrames = FMath::CeilToInt(Duration / FrameTime);
+		for (int32 Frame = 1; Frame <= NumFrames; ++Frame)
+		{
+			const double Now = Frame * FrameTime;
+			for (; NextEvent < Events.Num() && Events[NextEvent].Time <= Now; ++NextEvent)
+			{
+				if (Events[NextEvent].bPressed)
+				{
+					Scheduler.PressTrigger(Events[NextEvent].Time);
+				}
+				else
+				{
+					Scheduler.ReleaseTrigger(Events[NextEvent].Time);
+				}
+			}
+			Scheduler.Advance(Now, ShotTimes);
+		}
+		return ShotTimes;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFireSchedulerFrameRateTest, "ShooterTemplate.FireScheduler.FrameRateIndependence",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FFireSchedulerFrameRateTest::RunTest(const FString& Parameters)
+{
+	using namespace FireSchedulerTest;
+
+	struct FCase
+	{
+		const TCHAR* Name;
+		EFireMode FireMode;
+		TArray<FTriggerEvent> Events;
+		int32 ExpectedShots;
+	};
+
+	// 600 RPM, so one shot every 0.1 s
+	const FCase Cases[] = {
+		// A tap, then a second tap inside the rate of fire cooldown that waits it out
+		{TEXT("SemiAuto"), EFireMode::SemiAuto, {{0.105, true}, {0.11, false}, {0.15, true}, {0.16, false}}, 2},
+		// Released early, the burst still plays out
+		{TEXT("Burst"), EFireMode::Burst, {{0.105, true}, {0.11, false}}, 3},
+		// Held across several frames at both rates, and stopped by the release
+		{TEXT("FullAuto"), EFireMode::FullAuto, {{0.105, true}, {0.53, false}}, 5},
+	};
+
+	for (const FCase& Case : Cases)
+	{
+		const TArray<double> At30 = Run(Case.FireMode, Case.Events, 1.0 / 30.0, 1.0);
+		const TArray<double> At240 = Run(Case.FireMode, Case.Events, 1.0 / 240.0, 1.0);
+
+		TestEqual(FString::Printf(TEXT("%s shots at 30 fps"), Case.Name), At30.Num(), Case.ExpectedShots);
+		TestTrue(FString::Printf(TEXT("%s shot times match at 30 and 240 fps"), Case.Name), At30 == At240);
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GameplayEventBus.h"
+
+#include "Engine/World.h"
+#include "HAL/PlatformTLS.h"
+
+static FAutoConsoleCommandWithWorld GameplayEventStatsCommand(
+	TEXT("Shooter.Events.Stats"),
+	TEXT("Log how many gameplay events were delivered and dropped for the current world."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		const UGameplayEventBus* EventBus = World ? World->GetSubsystem<UGameplayEventBus>() : nullptr;
+		if (EventBus)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Gameplay events: %lld delivered, %lld dropped"),
+			       EventBus->GetNumDelivered(), EventBus->GetNumDropped());
+		}
+	}));
+
+static std::atomic<uint32> NextBusId{1};
+
+UGameplayEventBus::UGameplayEventBus()
+	: BusId(NextBusId.fetch_add(1, std::memory_order_relaxed))
+{
+}
+
+int64 UGameplayEventBus::GetNumDropped() const
+{
+	FScopeLock Lock(&ProducersLock);
+	int64 NumDropped = 0;
+	for (const TUniquePtr<FProducer>& Producer : Producers)
+	{
+		NumDropped += Producer->NumDropped.load(std::memory_order_relaxed);
+	}
+	return NumDropped;
+}
+
+void UGameplayEventBus::Tick(float DeltaTime)
+{
+	// Threads that publish for the first time meanwhile are picked up next frame
+	{
+		FScopeLock Lock(&ProducersLock);
+		for (const TUniquePtr<FProducer>& Producer : Producers)
+		{
+			Producer->Shots.Drain(ShotBatch);
+			Producer->Damage.Drain(DamageBatch);
+			Producer->Kills.Drain(KillBatch);
+		}
+	}
+	NumDelivered += ShotBatch.Num() + DamageBatch.Num() + KillBatch.Num();
+
+	// Subscribers can publish from here. Those events wait in the rings until next frame
+	if (ShotBatch.Num() > 0)
+	{
+		OnShots.Broadcast(ShotBatch);
+		ShotBatch.Reset();
+	}
+	if (DamageBatch.Num() > 0)
+	{
+		OnDamage.Broadcast(DamageBatch);
+		DamageBatch.Reset();
+	}
+	if (KillBatch.Num() > 0)
+	{
+		OnKills.Broadcast(KillBatch);
+		KillBatch.Reset();
+	}
+}
+
+bool UGameplayEventBus::IsTickable() const
+{
+	return !IsTemplate();
+}
+
+TStatId UGameplayEventBus::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGameplayEventBus, STATGROUP_Tickables);
+}
+
+UGameplayEventBus::FProducer& UGameplayEventBus::GetProducer()
+{
+	struct FThreadCache
+	{
+		uint32 BusId{0};
+		FProducer* Producer{nullptr};
+	};
+	static thread_local FThreadCache Cache;
+	if (Cache.BusId == BusId)
+	{
+		return *Cache.Producer;
+	}
+
+	// First event from this thread on this bus, or the thread last published to another world's bus
+	const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
+	FScopeLock Lock(&ProducersLock);
+	FProducer*& Producer = ProducerByThread.FindOrAdd(ThreadId);
+	if (Producer == nullptr)
+	{
+		Producer = Producers.Add_GetRef(MakeUnique<FProducer>(RingCapacity)).Get();
+	}
+	Cache.BusId = BusId;
+	Cache.Producer = Producer;
+	return *Producer;
+}
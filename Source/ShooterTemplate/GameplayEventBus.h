@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include <atomic>
+#include "GameplayEventBus.generated.h"
+
+/** A hitscan shot or projectile segment that has been traced */
+struct FShooterShotEvent
+{
+	TWeakObjectPtr<AActor> Shooter;
+	FVector Start{FVector::ZeroVector};
+
+	/** Impact point, or where the shot ran out */
+	FVector End{FVector::ZeroVector};
+
+	TWeakObjectPtr<AActor> HitActor;
+	bool bHit{false};
+	bool bProjectile{false};
+};
+
+/** Damage a character actually took, after clamping to its health */
+struct FShooterDamageEvent
+{
+	TWeakObjectPtr<AActor> Victim;
+	TWeakObjectPtr<AController> Instigator;
+	TWeakObjectPtr<AActor> DamageCauser;
+	float Damage{0.f};
+	float HealthAfter{0.f};
+};
+
+struct FShooterKillEvent
+{
+	TWeakObjectPtr<APawn> Victim;
+	TWeakObjectPtr<AController> Killer;
+	TWeakObjectPtr<AActor> DamageCauser;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnShooterShotEvents, TArrayView<const FShooterShotEvent>);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnShooterDamageEvents, TArrayView<const FShooterDamageEvent>);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnShooterKillEvents, TArrayView<const FShooterKillEvent>);
+
+/** Fixed-size ring with a single producer thread and a single consumer thread, never blocking either */
+template <typename EventType>
+class TGameplayEventRing
+{
+public:
+	explicit TGameplayEventRing(uint32 MinCapacity)
+	{
+		Events.SetNum(FMath::RoundUpToPowerOfTwo(FMath::Max<uint32>(MinCapacity, 2)));
+		Mask = Events.Num() - 1;
+	}
+
+	/** Producer thread only. False if the consumer fell a full ring behind */
+	FORCEINLINE bool Push(const EventType& Event)
+	{
+		const uint32 Head = WriteIndex.load(std::memory_order_relaxed);
+		if (Head - ReadIndex.load(std::memory_order_acquire) > Mask)
+		{
+			return false;
+		}
+		Events[Head & Mask] = Event;
+		WriteIndex.store(Head + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** Consumer thread only. Appends every event published so far */
+	void Drain(TArray<EventType>& OutEvents)
+	{
+		const uint32 Tail = ReadIndex.load(std::memory_order_relaxed);
+		const uint32 Head = WriteIndex.load(std::memory_order_acquire);
+		for (uint32 Index = Tail; Index != Head; ++Index)
+		{
+			OutEvents.Add(Events[Index & Mask]);
+		}
+		ReadIndex.store(Head, std::memory_order_release);
+	}
+
+private:
+	TArray<EventType> Events;
+	uint32 Mask{0};
+
+	/** Free running, wrapped with Mask. Padded apart so the two threads don't contend for a cache line */
+	std::atomic<uint32> WriteIndex{0};
+	uint8 Padding[PLATFORM_CACHE_LINE_SIZE];
+	std::atomic<uint32> ReadIndex{0};
+};
+
+/**
+ * Typed bus for shot, damage and kill events. Each thread that publishes gets its own rings on its
+ * first event, so publishing from the game thread, the shot trace task or projectile workers is a
+ * plain copy into preallocated memory without locks, allocation or virtual calls. Subscribers get all
+ * of a frame's events of a type in one batch, drained in the tickable object phase after every actor
+ * and component has ticked. Events published while the batches are broadcast arrive next frame.
+ */
+UCLASS(Config = Game)
+class SHOOTERTEMPLATE_API UGameplayEventBus : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+public:
+	UGameplayEventBus();
+
+	/** Safe from any thread. Dropped if this thread's ring is full */
+	template <typename EventType>
+	FORCEINLINE void Publish(const EventType& Event)
+	{
+		FProducer& Producer = GetProducer();
+		if (!Producer.Ring<EventType>().Push(Event))
+		{
+			Producer.NumDropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	FOnShooterShotEvents OnShots;
+	FOnShooterDamageEvents OnDamage;
+	FOnShooterKillEvents OnKills;
+
+	/** Events delivered and dropped since the world started */
+	FORCEINLINE int64 GetNumDelivered() const { return NumDelivered; }
+	int64 GetNumDropped() const;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+private:
+	/** Rings owned by one publishing thread */
+	struct FProducer
+	{
+		explicit FProducer(uint32 Capacity) : Shots(Capacity), Damage(Capacity), Kills(Capacity) {}
+
+		template <typename EventType>
+		TGameplayEventRing<EventType>& Ring();
+
+		TGameplayEventRing<FShooterShotEvent> Shots;
+		TGameplayEventRing<FShooterDamageEvent> Damage;
+		TGameplayEventRing<FShooterKillEvent> Kills;
+		std::atomic<int32> NumDropped{0};
+	};
+
+	/** This thread's rings, created on its first event */
+	FProducer& GetProducer();
+
+	/** Events each publishing thread can hold per type before dropping */
+	UPROPERTY(Config)
+	int32 RingCapacity{1024};
+
+	/** Tells this bus apart from a later one at the same address in the per-thread cache */
+	uint32 BusId{0};
+
+	/** Guards Producers and ProducerByThread. Only taken on a thread's first event and once per drain */
+	mutable FCriticalSection ProducersLock;
+	TArray<TUniquePtr<FProducer>> Producers;
+	TMap<uint32, FProducer*> ProducerByThread;
+
+	/** Batches handed to subscribers, reused every frame */
+	TArray<FShooterShotEvent> ShotBatch;
+	TArray<FShooterDamageEvent> DamageBatch;
+	TArray<FShooterKillEvent> KillBatch;
+
+	int64 NumDelivered{0};
+};
+
+template <>
+FORCEINLINE TGameplayEventRing<FShooterShotEvent>& UGameplayEventBus::FProducer::Ring<FShooterShotEvent>()
+{
+	return Shots;
+}
+
+template <>
+FORCEINLINE TGameplayEventRing<FShooterDamageEvent>& UGameplayEventBus::FProducer::Ring<FShooterDamageEvent>()
+{
+	return Damage;
+}
+
+template <>
+FORCEINLINE TGameplayEventRing<FShooterKillEvent>& UGameplayEventBus::FProducer::Ring<FShooterKillEvent>()
+{
+	return Kills;
+}
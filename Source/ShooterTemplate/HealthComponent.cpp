@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HealthComponent.h"
+
+#include "DamageQueueSubsystem.h"
+#include "ShooterTemplate.h"
+#include "SpatialHashSubsystem.h"
+#include "Engine/World.h"
+
+UHealthComponent::UHealthComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UHealthComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Health = MaxHealth;
+	GetOwner()->OnTakeAnyDamage.AddDynamic(this, &UHealthComponent::HandleTakeAnyDamage);
+	if (USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
+	{
+		SpatialHash->RegisterActor(GetOwner());
+	}
+}
+
+void UHealthComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>())
+	{
+		SpatialHash->UnregisterActor(GetOwner());
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+float UHealthComponent::QueueDamage(float DamageAmount, AController* EventInstigator, AActor* DamageCauser)
+{
+	if (DamageAmount <= 0.f || IsDead())
+	{
+		return 0.f;
+	}
+
+	UDamageQueueSubsystem* DamageQueue = GetWorld()->GetSubsystem<UDamageQueueSubsystem>();
+	if (DamageQueue == nullptr)
+	{
+		return 0.f;
+	}
+	DamageQueue->QueueDamage(this, DamageAmount, EventInstigator, DamageCauser);
+	return DamageAmount;
+}
+
+void UHealthComponent::Revive()
+{
+	Health = MaxHealth;
+	++Life;
+}
+
+void UHealthComponent::SetHealth(float NewHealth)
+{
+	Health = FMath::Clamp(NewHealth, 0.f, MaxHealth);
+}
+
+void UHealthComponent::HandleTakeAnyDamage(AActor* DamagedActor, float Damage, const UDamageType* DamageType,
+                                           AController* InstigatedBy, AActor* DamageCauser)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterTakeDamage);
+	QueueDamage(Damage, InstigatedBy, DamageCauser);
+}
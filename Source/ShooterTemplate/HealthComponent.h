@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "HealthComponent.generated.h"
+
+class UDamageType;
+
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnHealthDepleted, class UHealthComponent*, AController*, AActor*);
+
+/**
+ * Health of any damageable actor. Damage the owner takes through TakeDamage, point and radial damage
+ * included, is queued on UDamageQueueSubsystem and applied with every other hit of the frame in one
+ * pass. OnDeath fires once per life, from the queue's death phase after all of the frame's damage.
+ * The owner is kept in the spatial hash while it plays, so radial damage and target queries find it.
+ */
+UCLASS(ClassGroup = Combat, meta = (BlueprintSpawnableComponent))
+class SHOOTERTEMPLATE_API UHealthComponent : public UActorComponent
+{
+	GENERATED_BODY()
+public:
+	UHealthComponent();
+
+	/** Queue damage for this frame's resolve. Returns the damage queued, before clamping to the health left */
+	float QueueDamage(float DamageAmount, AController* EventInstigator, AActor* DamageCauser);
+
+	/** Back to full health. Damage queued before the revive is dropped */
+	void Revive();
+
+	/** Sets health directly, clamped to [0, MaxHealth]. Doesn't kill */
+	void SetHealth(float NewHealth);
+
+	FORCEINLINE float GetHealth() const { return Health; }
+	FORCEINLINE float GetMaxHealth() const { return MaxHealth; }
+	FORCEINLINE bool IsDead() const { return Health <= 0.f; }
+
+	/** Lives since begin play. Queued damage only applies to the life it was queued in */
+	FORCEINLINE uint32 GetLife() const { return Life; }
+
+	/** The component, the controller of the killing hit and its damage causer */
+	FOnHealthDepleted OnDeath;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	friend class UDamageQueueSubsystem;
+
+	UFUNCTION()
+	void HandleTakeAnyDamage(AActor* DamagedActor, float Damage, const UDamageType* DamageType,
+	                         AController* InstigatedBy, AActor* DamageCauser);
+
+	/** Health the owner spawns and revives with */
+	UPROPERTY(EditDefaultsOnly, Category = Combat)
+	float MaxHealth{100.f};
+
+	UPROPERTY(VisibleAnywhere, Category = Combat)
+	float Health{0.f};
+
+	uint32 Life{0};
+};
@@ -0,0 +1,424 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HitboxSubsystem.h"
+
+#include "ShooterCharacter.h"
+#include "ShooterTemplate.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "Math/RandomStream.h"
+
+static FAutoConsoleCommandWithWorldAndArgs HitboxBenchmarkCommand(
+	TEXT("Shooter.Hitboxes.Benchmark"),
+	TEXT("Time rays against the hitboxes and against the physics assets. Optional rays per character, default 1000."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		const UHitboxSubsystem* Hitboxes = World ? World->GetSubsystem<UHitboxSubsystem>() : nullptr;
+		if (Hitboxes)
+		{
+			Hitboxes->LogBenchmark(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000);
+		}
+	}));
+
+/** Lanes per vector register */
+static constexpr int32 HitboxLanes = 4;
+
+static FORCEINLINE VectorRegister VectorDot3SoA(const VectorRegister& AX, const VectorRegister& AY,
+                                                const VectorRegister& AZ, const VectorRegister& BX,
+                                                const VectorRegister& BY, const VectorRegister& BZ)
+{
+	return VectorMultiplyAdd(AX, BX, VectorMultiplyAdd(AY, BY, VectorMultiply(AZ, BZ)));
+}
+
+static FORCEINLINE VectorRegister VectorClamp01(const VectorRegister& Value)
+{
+	return VectorMin(VectorMax(Value, VectorZero()), VectorOne());
+}
+
+void UHitboxSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Stride = Align(Layout.Num(), HitboxLanes);
+	SetNumSlots(Align(FMath::Max(ReservedCharacters, 0), HitboxLanes));
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UHitboxSubsystem::OnWorldPostActorTick);
+}
+
+void UHitboxSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	SlotByCharacter.Empty();
+	PendingAdds.Empty();
+	PendingRemoves.Empty();
+	Super::Deinitialize();
+}
+
+void UHitboxSubsystem::RegisterCharacter(AShooterCharacter* Character)
+{
+	if (Character && Stride > 0)
+	{
+		PendingRemoves.Remove(Character);
+		PendingAdds.AddUnique(Character);
+	}
+}
+
+void UHitboxSubsystem::UnregisterCharacter(AShooterCharacter* Character)
+{
+	PendingAdds.Remove(Character);
+	PendingRemoves.AddUnique(Character);
+}
+
+bool UHitboxSubsystem::Raycast(const FVector& Start, const FVector& End, FHitboxHit& OutHit,
+                               const AActor* IgnoredActor) const
+{
+	const FVector Delta = End - Start;
+	const float LengthSquared = Delta.SizeSquared();
+	if (LengthSquared < KINDA_SMALL_NUMBER || SlotByCharacter.Num() == 0)
+	{
+		return false;
+	}
+
+	const VectorRegister PX = VectorSetFloat1(Start.X);
+	const VectorRegister PY = VectorSetFloat1(Start.Y);
+	const VectorRegister PZ = VectorSetFloat1(Start.Z);
+	const VectorRegister DX = VectorSetFloat1(Delta.X);
+	const VectorRegister DY = VectorSetFloat1(Delta.Y);
+	const VectorRegister DZ = VectorSetFloat1(Delta.Z);
+	const VectorRegister InvLengthSquared = VectorSetFloat1(1.f / LengthSquared);
+
+	// Broad phase, the segment against four bounding spheres at a time
+	bool bHit = false;
+	FHitboxHit Candidate;
+	for (int32 Base = 0; Base < BoundsRadius.Num(); Base += HitboxLanes)
+	{
+		const VectorRegister WX = VectorSubtract(VectorLoad(&BoundsX[Base]), PX);
+		const VectorRegister WY = VectorSubtract(VectorLoad(&BoundsY[Base]), PY);
+		const VectorRegister WZ = VectorSubtract(VectorLoad(&BoundsZ[Base]), PZ);
+		const VectorRegister Radius = VectorLoad(&BoundsRadius[Base]);
+
+		const VectorRegister S = VectorClamp01(VectorMultiply(VectorDot3SoA(WX, WY, WZ, DX, DY, DZ), InvLengthSquared));
+		const VectorRegister OffX = VectorSubtract(WX, VectorMultiply(DX, S));
+		const VectorRegister OffY = VectorSubtract(WY, VectorMultiply(DY, S));
+		const VectorRegister OffZ = VectorSubtract(WZ, VectorMultiply(DZ, S));
+		const VectorRegister DistanceSquared = VectorDot3SoA(OffX, OffY, OffZ, OffX, OffY, OffZ);
+
+		uint32 Lanes = VectorMaskBits(VectorCompareGT(VectorMultiply(Radius, Radius), DistanceSquared));
+		while (Lanes != 0)
+		{
+			const int32 Slot = Base + FMath::CountTrailingZeros(Lanes);
+			Lanes &= Lanes - 1;
+			if (CharacterKeys[Slot] != IgnoredActor && RaycastSlot(Slot, Start, Delta, Candidate) &&
+				(!bHit || Candidate.Distance < OutHit.Distance))
+			{
+				OutHit = Candidate;
+				bHit = true;
+			}
+		}
+	}
+	return bHit;
+}
+
+bool UHitboxSubsystem::RaycastCharacter(const AShooterCharacter* Character, const FVector& Start,
+                                        const FVector& End, FHitboxHit& OutHit) const
+{
+	const int32* Slot = SlotByCharacter.Find(Character);
+	const FVector Delta = End - Start;
+	return Slot && BoundsRadius[*Slot] > 0.f && Delta.SizeSquared() >= KINDA_SMALL_NUMBER &&
+		RaycastSlot(*Slot, Start, Delta, OutHit);
+}
+
+float UHitboxSubsystem::GetDamageMultiplier(EHitboxRegion Region) const
+{
+	switch (Region)
+	{
+	case EHitboxRegion::Head:
+		return HeadDamageMultiplier;
+	case EHitboxRegion::Limb:
+		return LimbDamageMultiplier;
+	default:
+		return 1.f;
+	}
+}
+
+void UHitboxSubsystem::LogBenchmark(int32 RaysPerCharacter) const
+{
+	FRandomStream Random(RaysPerCharacter);
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(HitboxBenchmark), true);
+	for (int32 Slot = 0; Slot < Meshes.Num(); ++Slot)
+	{
+		USkeletalMeshComponent* Mesh = Meshes[Slot].Get();
+		if (Mesh == nullptr || BoundsRadius[Slot] <= 0.f)
+		{
+			continue;
+		}
+
+		// Rays from all around the character, aimed at points inside its bounds
+		TArray<TPair<FVector, FVector>> Rays;
+		const FBoxSphereBounds& Bounds = Mesh->Bounds;
+		for (int32 Index = 0; Index < RaysPerCharacter; ++Index)
+		{
+			const FVector Target = Random.RandPointInBox(Bounds.GetBox());
+			const FVector From = Target + Random.GetUnitVector() * Bounds.SphereRadius * 4.f;
+			Rays.Emplace(From, Target + (Target - From));
+		}
+
+		int32 NumHitboxHits = 0;
+		FHitboxHit HitboxHit;
+		const double HitboxStart = FPlatformTime::Seconds();
+		for (const TPair<FVector, FVector>& Ray : Rays)
+		{
+			NumHitboxHits += RaycastSlot(Slot, Ray.Key, Ray.Value - Ray.Key, HitboxHit);
+		}
+		const double HitboxSeconds = FPlatformTime::Seconds() - HitboxStart;
+
+		int32 NumPhysicsHits = 0;
+		FHitResult PhysicsHit;
+		const double PhysicsStart = FPlatformTime::Seconds();
+		for (const TPair<FVector, FVector>& Ray : Rays)
+		{
+			NumPhysicsHits += Mesh->LineTraceComponent(PhysicsHit, Ray.Key, Ray.Value, Params);
+		}
+		const double PhysicsSeconds = FPlatformTime::Seconds() - PhysicsStart;
+
+		UE_LOG(LogTemp, Log, TEXT("Hitboxes %s: %.3f us per ray, physics asset %.3f us, %.1fx faster, %d vs %d hits"),
+		       *GetNameSafe(Mesh->GetOwner()), HitboxSeconds * 1e6 / FMath::Max(Rays.Num(), 1),
+		       PhysicsSeconds * 1e6 / FMath::Max(Rays.Num(), 1), PhysicsSeconds / FMath::Max(HitboxSeconds, 1e-9),
+		       NumHitboxHits, NumPhysicsHits);
+	}
+}
+
+void UHitboxSubsystem::OnWorldPostActorTick(UWorld* TickingWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (TickingWorld != GetWorld())
+	{
+		return;
+	}
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterHitboxUpdate);
+	ApplyRegistrations();
+
+	for (const TPair<const AActor*, int32>& Entry : SlotByCharacter)
+	{
+		const int32 Slot = Entry.Value;
+		const AActor* Character = Characters[Slot].Get();
+		const USkeletalMeshComponent* Mesh = Meshes[Slot].Get();
+
+		// Dormant and dead characters have no collision, and can't be hit
+		if (Character == nullptr || Mesh == nullptr || Character->IsHidden() || !Character->GetActorEnableCollision() ||
+			!Character->GetRootComponent()->IsCollisionEnabled())
+		{
+			BoundsRadius[Slot] = 0.f;
+			continue;
+		}
+
+		BoundsX[Slot] = Mesh->Bounds.Origin.X;
+		BoundsY[Slot] = Mesh->Bounds.Origin.Y;
+		BoundsZ[Slot] = Mesh->Bounds.Origin.Z;
+		BoundsRadius[Slot] = Mesh->Bounds.SphereRadius + BoundsPadding;
+
+		const TArray<FTransform>& BoneTransforms = Mesh->GetComponentSpaceTransforms();
+		const FTransform& ComponentTransform = Mesh->GetComponentTransform();
+		const float Scale = ComponentTransform.GetMaximumAxisScale();
+		for (int32 Index = 0; Index < Layout.Num(); ++Index)
+		{
+			const int32 Capsule = Slot * Stride + Index;
+			const int32 Bone = BoneIndices[Capsule * 2];
+			const int32 EndBone = BoneIndices[Capsule * 2 + 1];
+			if (!BoneTransforms.IsValidIndex(Bone))
+			{
+				Radii[Capsule] = 0.f;
+				continue;
+			}
+
+			const FVector Start = ComponentTransform.TransformPosition(BoneTransforms[Bone].GetLocation());
+			const FVector End = BoneTransforms.IsValidIndex(EndBone)
+				                    ? ComponentTransform.TransformPosition(BoneTransforms[EndBone].GetLocation())
+				                    : Start;
+			StartX[Capsule] = Start.X;
+			StartY[Capsule] = Start.Y;
+			StartZ[Capsule] = Start.Z;
+			AxisX[Capsule] = End.X - Start.X;
+			AxisY[Capsule] = End.Y - Start.Y;
+			AxisZ[Capsule] = End.Z - Start.Z;
+			Radii[Capsule] = Layout[Index].Radius * Scale;
+		}
+	}
+}
+
+void UHitboxSubsystem::ApplyRegistrations()
+{
+	for (const AActor* Character : PendingRemoves)
+	{
+		int32 Slot;
+		if (SlotByCharacter.RemoveAndCopyValue(Character, Slot))
+		{
+			Characters[Slot].Reset();
+			Meshes[Slot].Reset();
+			CharacterKeys[Slot] = nullptr;
+			BoundsRadius[Slot] = 0.f;
+		}
+	}
+	PendingRemoves.Reset();
+
+	int32 FreeSlot = 0;
+	for (const TWeakObjectPtr<AShooterCharacter>& WeakCharacter : PendingAdds)
+	{
+		AShooterCharacter* Character = WeakCharacter.Get();
+		if (Character == nullptr || SlotByCharacter.Contains(Character))
+		{
+			continue;
+		}
+		while (FreeSlot < Characters.Num() && CharacterKeys[FreeSlot] != nullptr)
+		{
+			++FreeSlot;
+		}
+		if (FreeSlot >= Characters.Num())
+		{
+			// Every character must have hitboxes, shots don't trace pawns' collision once any do
+			SetNumSlots(FMath::Max(Characters.Num() * 2, HitboxLanes));
+		}
+
+		// Bone indices are baked once, so the update is a straight copy
+		USkeletalMeshComponent* Mesh = Character->GetMesh();
+		for (int32 Index = 0; Index < Layout.Num(); ++Index)
+		{
+			const int32 Capsule = FreeSlot * Stride + Index;
+			BoneIndices[Capsule * 2] = Mesh->GetBoneIndex(Layout[Index].Bone);
+			BoneIndices[Capsule * 2 + 1] = Layout[Index].EndBone.IsNone()
+				                               ? INDEX_NONE
+				                               : Mesh->GetBoneIndex(Layout[Index].EndBone);
+		}
+		Characters[FreeSlot] = Character;
+		Meshes[FreeSlot] = Mesh;
+		CharacterKeys[FreeSlot] = Character;
+		BoundsRadius[FreeSlot] = 0.f;
+		SlotByCharacter.Add(Character, FreeSlot);
+	}
+	PendingAdds.Reset();
+}
+
+void UHitboxSubsystem::SetNumSlots(int32 NumSlots)
+{
+	const int32 OldNumCapsules = BoneIndices.Num() / 2;
+	Characters.SetNum(NumSlots);
+	Meshes.SetNum(NumSlots);
+	CharacterKeys.SetNumZeroed(NumSlots);
+	BoneIndices.SetNumUninitialized(NumSlots * Stride * 2);
+	for (int32 Index = OldNumCapsules * 2; Index < BoneIndices.Num(); ++Index)
+	{
+		BoneIndices[Index] = INDEX_NONE;
+	}
+	BoundsX.SetNumZeroed(NumSlots);
+	BoundsY.SetNumZeroed(NumSlots);
+	BoundsZ.SetNumZeroed(NumSlots);
+	BoundsRadius.SetNumZeroed(NumSlots);
+	StartX.SetNumZeroed(NumSlots * Stride);
+	StartY.SetNumZeroed(NumSlots * Stride);
+	StartZ.SetNumZeroed(NumSlots * Stride);
+	AxisX.SetNumZeroed(NumSlots * Stride);
+	AxisY.SetNumZeroed(NumSlots * Stride);
+	AxisZ.SetNumZeroed(NumSlots * Stride);
+	Radii.SetNumZeroed(NumSlots * Stride);
+	SlotByCharacter.Reserve(NumSlots);
+}
+
+bool UHitboxSubsystem::RaycastSlot(int32 Slot, const FVector& Start, const FVector& Delta, FHitboxHit& OutHit) const
+{
+	// Closest points between the segment and four capsule axes at a time, clamped to both segments
+	const float LengthSquared = Delta.SizeSquared();
+	const VectorRegister PX = VectorSetFloat1(Start.X);
+	const VectorRegister PY = VectorSetFloat1(Start.Y);
+	const VectorRegister PZ = VectorSetFloat1(Start.Z);
+	const VectorRegister DX = VectorSetFloat1(Delta.X);
+	const VectorRegister DY = VectorSetFloat1(Delta.Y);
+	const VectorRegister DZ = VectorSetFloat1(Delta.Z);
+	const VectorRegister A = VectorSetFloat1(LengthSquared);
+	const VectorRegister InvA = VectorSetFloat1(1.f / LengthSquared);
+	const VectorRegister ParallelTolerance = VectorSetFloat1(1e-6f);
+	const VectorRegister MinAxisSquared = VectorSetFloat1(SMALL_NUMBER);
+
+	int32 BestCapsule = INDEX_NONE;
+	float BestDistance = 0.f;
+	float BestAxisT = 0.f;
+	const float Length = FMath::Sqrt(LengthSquared);
+	for (int32 Base = Slot * Stride; Base < (Slot + 1) * Stride; Base += HitboxLanes)
+	{
+		const VectorRegister EX = VectorLoad(&AxisX[Base]);
+		const VectorRegister EY = VectorLoad(&AxisY[Base]);
+		const VectorRegister EZ = VectorLoad(&AxisZ[Base]);
+		const VectorRegister RX = VectorSubtract(PX, VectorLoad(&StartX[Base]));
+		const VectorRegister RY = VectorSubtract(PY, VectorLoad(&StartY[Base]));
+		const VectorRegister RZ = VectorSubtract(PZ, VectorLoad(&StartZ[Base]));
+		const VectorRegister Radius = VectorLoad(&Radii[Base]);
+
+		const VectorRegister E = VectorDot3SoA(EX, EY, EZ, EX, EY, EZ);
+		const VectorRegister F = VectorDot3SoA(EX, EY, EZ, RX, RY, RZ);
+		const VectorRegister C = VectorDot3SoA(DX, DY, DZ, RX, RY, RZ);
+		const VectorRegister B = VectorDot3SoA(DX, DY, DZ, EX, EY, EZ);
+		const VectorRegister AE = VectorMultiply(A, E);
+		const VectorRegister Denom = VectorSubtract(AE, VectorMultiply(B, B));
+
+		// Parallel segments and spheres start from the ray's start, the axis clamp below fixes them up
+		const VectorRegister NotParallel = VectorCompareGT(Denom, VectorMultiply(AE, ParallelTolerance));
+		VectorRegister S = VectorDivide(VectorSubtract(VectorMultiply(B, F), VectorMultiply(C, E)),
+		                                VectorMax(Denom, MinAxisSquared));
+		S = VectorSelect(NotParallel, VectorClamp01(S), VectorZero());
+		const VectorRegister T = VectorClamp01(VectorDivide(VectorMultiplyAdd(B, S, F), VectorMax(E, MinAxisSquared)));
+		S = VectorClamp01(VectorMultiply(VectorSubtract(VectorMultiply(B, T), C), InvA));
+
+		const VectorRegister OffX = VectorSubtract(VectorMultiplyAdd(DX, S, RX), VectorMultiply(EX, T));
+		const VectorRegister OffY = VectorSubtract(VectorMultiplyAdd(DY, S, RY), VectorMultiply(EY, T));
+		const VectorRegister OffZ = VectorSubtract(VectorMultiplyAdd(DZ, S, RZ), VectorMultiply(EZ, T));
+		const VectorRegister DistanceSquared = VectorDot3SoA(OffX, OffY, OffZ, OffX, OffY, OffZ);
+		const VectorRegister RadiusSquared = VectorMultiply(Radius, Radius);
+
+		uint32 Lanes = VectorMaskBits(VectorCompareGT(RadiusSquared, DistanceSquared));
+		if (Lanes == 0)
+		{
+			continue;
+		}
+
+		float LaneS[HitboxLanes];
+		float LaneT[HitboxLanes];
+		float LaneDistanceSquared[HitboxLanes];
+		float LaneRadiusSquared[HitboxLanes];
+		VectorStore(S, LaneS);
+		VectorStore(T, LaneT);
+		VectorStore(DistanceSquared, LaneDistanceSquared);
+		VectorStore(RadiusSquared, LaneRadiusSquared);
+		while (Lanes != 0)
+		{
+			const int32 Lane = FMath::CountTrailingZeros(Lanes);
+			Lanes &= Lanes - 1;
+
+			// Back from the closest approach to where the ray enters the capsule
+			const float Entry = FMath::Sqrt(LaneRadiusSquared[Lane] - LaneDistanceSquared[Lane]);
+			const float Distance = FMath::Max(LaneS[Lane] * Length - Entry, 0.f);
+			if (BestCapsule == INDEX_NONE || Distance < BestDistance)
+			{
+				BestCapsule = Base + Lane;
+				BestDistance = Distance;
+				BestAxisT = LaneT[Lane];
+			}
+		}
+	}
+
+	if (BestCapsule == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FHitboxBone& Bone = Layout[BestCapsule - Slot * Stride];
+	const FVector OnAxis(StartX[BestCapsule] + AxisX[BestCapsule] * BestAxisT,
+	                     StartY[BestCapsule] + AxisY[BestCapsule] * BestAxisT,
+	                     StartZ[BestCapsule] + AxisZ[BestCapsule] * BestAxisT);
+	OutHit.Character = Characters[Slot];
+	OutHit.Mesh = Meshes[Slot];
+	OutHit.Distance = BestDistance;
+	OutHit.Location = Start + Delta * (BestDistance / Length);
+	OutHit.Normal = (OutHit.Location - OnAxis).GetSafeNormal();
+	OutHit.Bone = Bone.Bone;
+	OutHit.Region = Bone.Region;
+	return true;
+}
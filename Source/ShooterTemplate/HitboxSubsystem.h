@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "HitboxSubsystem.generated.h"
+
+class AShooterCharacter;
+class USkeletalMeshComponent;
+
+/** Part of the body a hitbox covers, which picks the damage multiplier */
+UENUM()
+enum class EHitboxRegion : uint8
+{
+	Torso,
+	Head,
+	Limb
+};
+
+/** One capsule of the hitbox layout, from Bone to EndBone. A sphere around Bone when EndBone is None */
+USTRUCT()
+struct FHitboxBone
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Config)
+	FName Bone;
+
+	UPROPERTY(Config)
+	FName EndBone;
+
+	UPROPERTY(Config)
+	float Radius{10.f};
+
+	UPROPERTY(Config)
+	EHitboxRegion Region{EHitboxRegion::Torso};
+};
+
+/** A ray's first hitbox */
+struct FHitboxHit
+{
+	TWeakObjectPtr<AActor> Character;
+	TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+
+	/** Along the ray, from its start */
+	float Distance{0.f};
+	FVector Location{FVector::ZeroVector};
+	FVector Normal{FVector::ZeroVector};
+	FName Bone;
+	EHitboxRegion Region{EHitboxRegion::Torso};
+};
+
+/**
+ * Per-bone hitboxes for every character, for hitscan shots without tracing the physics assets. The
+ * layout's capsules are copied from each skeletal mesh's bone transforms once per frame into
+ * structure-of-arrays buffers, padded to the vector width. A ray is first tested against every
+ * character's bounding sphere, four characters at a time, and only the characters it passes are tested
+ * against their capsules, four capsules at a time.
+ *
+ * Buffers are only written after actors tick and before tickable objects, so queries are safe from the
+ * shot trace task. Registration is applied on the next update for the same reason, and so is growing the
+ * buffers when more characters register than there are slots.
+ */
+UCLASS(Config = Game)
+class SHOOTERTEMPLATE_API UHitboxSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Start updating a character's hitboxes. The slots grow once every reserved one is taken */
+	void RegisterCharacter(AShooterCharacter* Character);
+	void UnregisterCharacter(AShooterCharacter* Character);
+
+	/** Nearest hitbox along the segment of any character but IgnoredActor. Safe from any thread */
+	bool Raycast(const FVector& Start, const FVector& End, FHitboxHit& OutHit,
+	             const AActor* IgnoredActor = nullptr) const;
+
+	/** Nearest hitbox of one character along the segment. Safe from any thread */
+	bool RaycastCharacter(const AShooterCharacter* Character, const FVector& Start, const FVector& End,
+	                      FHitboxHit& OutHit) const;
+
+	/** Damage scale for hits on a region */
+	float GetDamageMultiplier(EHitboxRegion Region) const;
+
+	/** True once a character has hitboxes, so shots can skip tracing pawns */
+	FORCEINLINE bool HasCharacters() const { return SlotByCharacter.Num() > 0; }
+
+	/** Time rays at every tracked character against the hitboxes and against its physics asset, and log both */
+	void LogBenchmark(int32 RaysPerCharacter) const;
+
+private:
+	/** Copy every tracked character's bones into the capsule buffers */
+	void OnWorldPostActorTick(UWorld* TickingWorld, ELevelTick TickType, float DeltaSeconds);
+
+	void ApplyRegistrations();
+
+	/** Resize every per-slot buffer. New slots are empty */
+	void SetNumSlots(int32 NumSlots);
+
+	/** Nearest capsule of one slot along the segment. OutHit is only written on a hit */
+	bool RaycastSlot(int32 Slot, const FVector& Start, const FVector& Delta, FHitboxHit& OutHit) const;
+
+	UPROPERTY(Config)
+	TArray<FHitboxBone> Layout;
+
+	/** Slots allocated up front. The buffers double when they fill, so this only avoids regrowing */
+	UPROPERTY(Config)
+	int32 ReservedCharacters{64};
+
+	/** Added to the mesh's bounding sphere, for capsules that stick out of it */
+	UPROPERTY(Config)
+	float BoundsPadding{10.f};
+
+	UPROPERTY(Config)
+	float HeadDamageMultiplier{2.f};
+
+	UPROPERTY(Config)
+	float LimbDamageMultiplier{0.75f};
+
+	/** Capsules per slot, the layout rounded up to the vector width */
+	int32 Stride{0};
+
+	/** Tracked character of each slot, and its pointer as a key only, never dereferenced off the game thread */
+	TArray<TWeakObjectPtr<AActor>> Characters;
+	TArray<TWeakObjectPtr<USkeletalMeshComponent>> Meshes;
+	TArray<const AActor*> CharacterKeys;
+
+	/** Layout bones resolved against each slot's skeleton, two per capsule. INDEX_NONE if missing */
+	TArray<int32> BoneIndices;
+
+	/** Bounding sphere per slot. A radius of zero never hits */
+	TArray<float> BoundsX;
+	TArray<float> BoundsY;
+	TArray<float> BoundsZ;
+	TArray<float> BoundsRadius;
+
+	/** Capsule start and axis (end minus start), Stride per slot. A radius of zero never hits */
+	TArray<float> StartX;
+	TArray<float> StartY;
+	TArray<float> StartZ;
+	TArray<float> AxisX;
+	TArray<float> AxisY;
+	TArray<float> AxisZ;
+	TArray<float> Radii;
+
+	/** Slot of each tracked character */
+	TMap<const AActor*, int32> SlotByCharacter;
+
+	/** Registrations waiting for the next update */
+	TArray<TWeakObjectPtr<AShooterCharacter>> PendingAdds;
+	TArray<const AActor*> PendingRemoves;
+
+	FDelegateHandle PostActorTickHandle;
+};
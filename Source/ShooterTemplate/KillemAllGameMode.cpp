@@ -3,13 +3,168 @@
 
 #include "KillemAllGameMode.h"
 
+#include "CrowdSubsystem.h"
+#include "ShooterTemplate.h"
+#include "Engine/World.h"
+
+AKillemAllGameMode::AKillemAllGameMode()
+{
+	GameStateClass = AShooterTemplateGameState::StaticClass();
+}
+
+void AKillemAllGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UCrowdSubsystem* Crowd = GetWorld()->GetSubsystem<UCrowdSubsystem>())
+	{
+		Crowd->OnAgentKilled.AddUObject(this, &AKillemAllGameMode::OnCrowdAgentKilled);
+	}
+	PublishMatchState();
+}
+
 void AKillemAllGameMode::PawnKilled(APawn* PawnKilled)
 {
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterPawnKilled);
 	Super::PawnKilled(PawnKilled);
-	APlayerController* PlayerController = Cast<APlayerController>(PawnKilled->GetController());
 
-	if (PlayerController != nullptr)
+	FRegisteredPawn* Registered = RegisteredPawns.Find(PawnKilled);
+	if (Registered == nullptr || !Registered->bAlive)
+	{
+		return;
+	}
+
+	Registered->bAlive = false;
+	if (Registered->Team == EShooterTeam::Players)
+	{
+		--MatchState.PlayersAlive;
+		++MatchState.PlayersDead;
+	}
+	else
+	{
+		--MatchState.BotsAlive;
+		++MatchState.BotsDead;
+	}
+	EvaluateMatch();
+	PublishMatchState();
+}
+
+void AKillemAllGameMode::PawnEnteredMatch(APawn* Pawn)
+{
+	if (Pawn == nullptr || RegisteredPawns.Contains(Pawn))
+	{
+		return;
+	}
+
+	const EShooterTeam Team = Pawn->IsPlayerControlled() ? EShooterTeam::Players : EShooterTeam::Bots;
+	RegisteredPawns.Add(Pawn, {Team, true});
+	if (Team == EShooterTeam::Players)
+	{
+		++MatchState.PlayersAlive;
+	}
+	else
+	{
+		++MatchState.BotsAlive;
+	}
+	PublishMatchState();
+}
+
+void AKillemAllGameMode::PawnLeftMatch(APawn* Pawn)
+{
+	FRegisteredPawn Registered;
+	if (!RegisteredPawns.RemoveAndCopyValue(Pawn, Registered) || !Registered.bAlive)
+	{
+		return;
+	}
+
+	// Removed without dying, e.g. a demoted crowd agent. Not a death, so no evaluation
+	if (Registered.Team == EShooterTeam::Players)
+	{
+		--MatchState.PlayersAlive;
+	}
+	else
+	{
+		--MatchState.BotsAlive;
+	}
+	PublishMatchState();
+}
+
+void AKillemAllGameMode::ResetRound()
+{
+	Super::ResetRound();
+
+	// Every registered character was revived
+	MatchState = FMatchState();
+	for (TPair<const APawn*, FRegisteredPawn>& Registered : RegisteredPawns)
+	{
+		Registered.Value.bAlive = true;
+		if (Registered.Value.Team == EShooterTeam::Players)
+		{
+			++MatchState.PlayersAlive;
+		}
+		else
+		{
+			++MatchState.BotsAlive;
+		}
+	}
+	PublishMatchState();
+}
+
+void AKillemAllGameMode::OnCrowdAgentKilled(int32 AgentId)
+{
+	++MatchState.BotsDead;
+	EvaluateMatch();
+	PublishMatchState();
+}
+
+void AKillemAllGameMode::EvaluateMatch()
+{
+	if (MatchState.bMatchOver)
+	{
+		return;
+	}
+
+	const UCrowdSubsystem* Crowd = GetWorld()->GetSubsystem<UCrowdSubsystem>();
+	const int32 CrowdAlive = Crowd ? Crowd->GetNumAliveFragments() : 0;
+	if (MatchState.PlayersDead > 0 && MatchState.PlayersAlive == 0)
+	{
+		EndGame(false);
+	}
+	else if (MatchState.BotsDead > 0 && MatchState.BotsAlive + CrowdAlive == 0)
+	{
+		EndGame(true);
+	}
+}
+
+void AKillemAllGameMode::EndGame(bool bPlayersWon)
+{
+	MatchState.bMatchOver = true;
+	MatchState.bPlayersWon = bPlayersWon;
+
+	// Once per match, so walking the controllers here is fine
+	for (FConstControllerIterator It = GetWorld()->GetControllerIterator(); It; ++It)
+	{
+		AController* Controller = It->Get();
+		if (Controller)
+		{
+			const bool bIsWinner = Controller->IsPlayerController() == bPlayersWon;
+			Controller->GameHasEnded(Controller->GetPawn(), bIsWinner);
+		}
+	}
+	ScheduleRoundReset();
+}
+
+void AKillemAllGameMode::PublishMatchState()
+{
+	// Crowd agents that aren't actors are counted with the bots for display
+	FMatchState Published = MatchState;
+	if (const UCrowdSubsystem* Crowd = GetWorld()->GetSubsystem<UCrowdSubsystem>())
+	{
+		Published.BotsAlive += Crowd->GetNumAliveFragments();
+	}
+
+	if (AShooterTemplateGameState* ShooterGameState = GetGameState<AShooterTemplateGameState>())
 	{
-		PlayerController->GameHasEnded(nullptr, false);
+		ShooterGameState->SetMatchState(Published);
 	}
 }
@@ -4,10 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "ShooterTemplateGameModeBase.h"
+#include "ShooterTemplateGameState.h"
 #include "KillemAllGameMode.generated.h"
 
 /**
- * 
+ * Players win once every bot is dead and lose once every player is dead. Alive and dead counts per
+ * team are kept in a registry that is updated as pawns are possessed, killed and removed, so each
+ * death is evaluated in constant time.
  */
 UCLASS()
 class SHOOTERTEMPLATE_API AKillemAllGameMode : public AShooterTemplateGameModeBase
@@ -15,5 +18,40 @@ class SHOOTERTEMPLATE_API AKillemAllGameMode : public AShooterTemplateGameModeBa
 	GENERATED_BODY()
 
 public:
+	AKillemAllGameMode();
+
 	virtual void PawnKilled(APawn* PawnKilled) override;
+	virtual void PawnEnteredMatch(APawn* Pawn) override;
+	virtual void PawnLeftMatch(APawn* Pawn) override;
+	virtual void ResetRound() override;
+
+	/** Registered pawns only. The game state's copy also counts crowd agents that aren't actors */
+	UFUNCTION(BlueprintPure, Category = Match)
+	const FMatchState& GetMatchState() const { return MatchState; }
+
+protected:
+	virtual void BeginPlay() override;
+
+private:
+	void OnCrowdAgentKilled(int32 AgentId);
+
+	/** End the match if a team has nobody left alive */
+	void EvaluateMatch();
+
+	/** Tell every controller whether its side won */
+	void EndGame(bool bPlayersWon);
+
+	/** Push MatchState to the game state for the HUD */
+	void PublishMatchState();
+
+	struct FRegisteredPawn
+	{
+		EShooterTeam Team;
+		bool bAlive;
+	};
+
+	/** Every pawn in the match. Dead pawns stay until they are removed from the world or go dormant in the pawn pool */
+	TMap<const APawn*, FRegisteredPawn> RegisteredPawns;
+
+	FMatchState MatchState;
 };
@@ -0,0 +1,225 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LagCompensationSubsystem.h"
+
+#include "ShooterCharacter.h"
+#include "ShooterTemplate.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+
+void ULagCompensationSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Samples.SetNum(MaxTrackedCharacters * HistoryLength);
+	Histories.SetNum(MaxTrackedCharacters);
+	SlotByCharacter.Reserve(MaxTrackedCharacters);
+}
+
+void ULagCompensationSubsystem::Deinitialize()
+{
+	Samples.Empty();
+	Histories.Empty();
+	SlotByCharacter.Empty();
+	Super::Deinitialize();
+}
+
+void ULagCompensationSubsystem::RegisterCharacter(AShooterCharacter* Character)
+{
+	if (Character == nullptr || SlotByCharacter.Contains(Character))
+	{
+		return;
+	}
+
+	for (int32 Slot = 0; Slot < Histories.Num(); ++Slot)
+	{
+		if (!Histories[Slot].Character.IsValid())
+		{
+			Histories[Slot] = FHitboxHistory();
+			Histories[Slot].Character = Character;
+			SlotByCharacter.Add(Character, Slot);
+			return;
+		}
+	}
+}
+
+void ULagCompensationSubsystem::UnregisterCharacter(AShooterCharacter* Character)
+{
+	int32 Slot;
+	if (SlotByCharacter.RemoveAndCopyValue(Character, Slot))
+	{
+		Histories[Slot] = FHitboxHistory();
+	}
+}
+
+bool ULagCompensationSubsystem::RewindCharacter(const AShooterCharacter* Character, float Time,
+                                                FHitboxSample& OutSample) const
+{
+	const int32* Slot = SlotByCharacter.Find(Character);
+	if (Slot == nullptr || Histories[*Slot].Count == 0)
+	{
+		return false;
+	}
+
+	// Clamp to the recorded window
+	const int32 Count = Histories[*Slot].Count;
+	if (Time <= GetSample(*Slot, 0).Time)
+	{
+		OutSample = GetSample(*Slot, 0);
+		return true;
+	}
+	if (Time >= GetSample(*Slot, Count - 1).Time)
+	{
+		OutSample = GetSample(*Slot, Count - 1);
+		return true;
+	}
+
+	// First sample at or after Time. Samples are in time order, so this is a binary search
+	int32 Low = 1;
+	int32 High = Count - 1;
+	while (Low < High)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if (GetSample(*Slot, Mid).Time < Time)
+		{
+			Low = Mid + 1;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	const FHitboxSample& Before = GetSample(*Slot, Low - 1);
+	const FHitboxSample& After = GetSample(*Slot, Low);
+	const float Alpha = (Time - Before.Time) / FMath::Max(After.Time - Before.Time, KINDA_SMALL_NUMBER);
+	OutSample.Time = Time;
+	OutSample.Location = FMath::Lerp(Before.Location, After.Location, Alpha);
+	OutSample.Rotation = FQuat::Slerp(Before.Rotation, After.Rotation, Alpha);
+	OutSample.Radius = FMath::Lerp(Before.Radius, After.Radius, Alpha);
+	OutSample.HalfHeight = FMath::Lerp(Before.HalfHeight, After.HalfHeight, Alpha);
+	return true;
+}
+
+bool ULagCompensationSubsystem::ValidateHit(const AShooterCharacter* Shooter, const AShooterCharacter* Target,
+                                            const FVector& AimStart, const FVector& AimDirection, float FireTime,
+                                            FVector& OutHitLocation) const
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterLagCompensation);
+	if (Shooter == nullptr || Target == nullptr || Target->IsDead() || AimDirection.IsNearlyZero())
+	{
+		return false;
+	}
+
+	const float Now = GetServerTime();
+	const float RewindTime = FMath::Clamp(FireTime, Now - MaxRewindTime, Now);
+
+	// The shot has to start near where the shooter was
+	FHitboxSample ShooterSample;
+	const FVector ShooterLocation = RewindCharacter(Shooter, RewindTime, ShooterSample)
+		                                ? ShooterSample.Location
+		                                : Shooter->GetActorLocation();
+	if (FVector::DistSquared(AimStart, ShooterLocation) > FMath::Square(MaxAimStartError))
+	{
+		return false;
+	}
+
+	FHitboxSample TargetSample;
+	if (!RewindCharacter(Target, RewindTime, TargetSample))
+	{
+		return false;
+	}
+
+	// Segment through the middle of the rewound capsule
+	const FVector Up = TargetSample.Rotation.GetUpVector();
+	const float SegmentHalfLength = FMath::Max(TargetSample.HalfHeight - TargetSample.Radius, 0.f);
+	const FVector CapsuleBottom = TargetSample.Location - Up * SegmentHalfLength;
+	const FVector CapsuleTop = TargetSample.Location + Up * SegmentHalfLength;
+	const float MaxDistance = TargetSample.Radius + HitTolerance;
+
+	// The ray must pass through the capsule
+	const FVector Direction = AimDirection.GetSafeNormal();
+	const FVector AimEnd = AimStart + Direction * MaxShotRange;
+	FVector OnRay;
+	FVector OnCapsule;
+	FMath::SegmentDistToSegmentSafe(AimStart, AimEnd, CapsuleBottom, CapsuleTop, OnRay, OnCapsule);
+	const float DistanceSquared = FVector::DistSquared(OnRay, OnCapsule);
+	if (DistanceSquared > FMath::Square(MaxDistance))
+	{
+		return false;
+	}
+
+	// It enters the capsule short of where it passes closest to the axis
+	const FVector HitLocation = OnRay - Direction * FMath::Sqrt(FMath::Square(MaxDistance) - DistanceSquared);
+
+	// Nothing static in the way. Pawns ignore the visibility channel, so only the level is tested
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(LagCompensationOcclusion), false, Shooter);
+	Params.AddIgnoredActor(Target);
+	if (GetWorld()->LineTraceTestByChannel(AimStart, HitLocation, ECollisionChannel::ECC_Visibility, Params))
+	{
+		return false;
+	}
+	OutHitLocation = HitLocation;
+	return true;
+}
+
+bool ULagCompensationSubsystem::IsRecentFireTime(float FireTime) const
+{
+	const float Now = GetServerTime();
+	return FireTime >= Now - MaxRewindTime && FireTime <= Now + MaxFireTimeLead;
+}
+
+float ULagCompensationSubsystem::GetServerTime() const
+{
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	return GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+}
+
+void ULagCompensationSubsystem::Tick(float DeltaTime)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterLagCompensation);
+	// Ticks after every actor, so this is where each character ended the frame
+	const float Now = GetServerTime();
+	for (int32 Slot = 0; Slot < Histories.Num(); ++Slot)
+	{
+		FHitboxHistory& History = Histories[Slot];
+		const AShooterCharacter* Character = History.Character.Get();
+		if (Character == nullptr)
+		{
+			continue;
+		}
+
+		const UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+		FHitboxSample& Sample = Samples[Slot * HistoryLength + History.Head];
+		Sample.Time = Now;
+		Sample.Location = Capsule->GetComponentLocation();
+		Sample.Rotation = Capsule->GetComponentQuat();
+		Sample.Radius = Capsule->GetScaledCapsuleRadius();
+		Sample.HalfHeight = Capsule->GetScaledCapsuleHalfHeight();
+
+		History.Head = (History.Head + 1) % HistoryLength;
+		History.Count = FMath::Min(History.Count + 1, HistoryLength);
+	}
+}
+
+bool ULagCompensationSubsystem::IsTickable() const
+{
+	// Only a server with remote clients has anything to compensate for
+	const UWorld* World = GetWorld();
+	return !IsTemplate() && SlotByCharacter.Num() > 0 && World && World->GetNetMode() != NM_Client
+		&& World->GetNetMode() != NM_Standalone;
+}
+
+TStatId ULagCompensationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+const FHitboxSample& ULagCompensationSubsystem::GetSample(int32 Slot, int32 Index) const
+{
+	const FHitboxHistory& History = Histories[Slot];
+	const int32 Oldest = (History.Head - History.Count + HistoryLength) % HistoryLength;
+	return Samples[Slot * HistoryLength + (Oldest + Index) % HistoryLength];
+}
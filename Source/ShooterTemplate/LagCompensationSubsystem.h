@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "LagCompensationSubsystem.generated.h"
+
+class AShooterCharacter;
+
+/** Capsule hitbox of one character at one point in time */
+struct FHitboxSample
+{
+	float Time{0.f};
+	FVector Location{FVector::ZeroVector};
+	FQuat Rotation{FQuat::Identity};
+	float Radius{0.f};
+	float HalfHeight{0.f};
+};
+
+/**
+ * Server-side hit validation for client-claimed shots. Every tracked character owns a fixed window of
+ * one contiguous sample buffer, written as a ring once per frame. A claim is checked against the target
+ * rewound to the time the client fired, then against static geometry, before any damage is applied.
+ * Nothing here allocates after Initialize, and a rewind is a binary search over one window.
+ */
+UCLASS(Config = Game)
+class SHOOTERTEMPLATE_API ULagCompensationSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Start recording a character's hitbox. Does nothing once MaxTrackedCharacters are tracked */
+	void RegisterCharacter(AShooterCharacter* Character);
+	void UnregisterCharacter(AShooterCharacter* Character);
+
+	/** Hitbox of a tracked character at Time, interpolated between samples. False if untracked */
+	bool RewindCharacter(const AShooterCharacter* Character, float Time, FHitboxSample& OutSample) const;
+
+	/**
+	 * Replay one ray of a shot a client claims hit Target, against Target rewound to when it was fired
+	 * @param FireTime server world time on the client when the shot was fired
+	 * @param OutHitLocation where the ray enters the rewound capsule. Only set on a hit
+	 */
+	bool ValidateHit(const AShooterCharacter* Shooter, const AShooterCharacter* Target, const FVector& AimStart,
+	                 const FVector& AimDirection, float FireTime, FVector& OutHitLocation) const;
+
+	/**
+	 * True if a client could have fired a shot at FireTime: no further back than a claim can be rewound,
+	 * and no further ahead than the client's estimate of the server clock can run
+	 */
+	bool IsRecentFireTime(float FireTime) const;
+
+	/** Current server world time, the clock all samples are stamped with */
+	float GetServerTime() const;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+private:
+	/** Ring bookkeeping for one tracked character */
+	struct FHitboxHistory
+	{
+		TWeakObjectPtr<AShooterCharacter> Character;
+		/** Slot the next sample is written to, relative to the window */
+		int32 Head{0};
+		int32 Count{0};
+	};
+
+	/** Sample Index (0 is oldest) of a tracked character's window */
+	const FHitboxSample& GetSample(int32 Slot, int32 Index) const;
+
+	UPROPERTY(Config)
+	int32 MaxTrackedCharacters{64};
+
+	/** Samples kept per character. At 60 Hz the default covers one second */
+	UPROPERTY(Config)
+	int32 HistoryLength{64};
+
+	/** Claims older than this are checked against the oldest time we accept */
+	UPROPERTY(Config)
+	float MaxRewindTime{0.5f};
+
+	/** Furthest ahead of the server's clock a client may stamp a shot */
+	UPROPERTY(Config)
+	float MaxFireTimeLead{0.1f};
+
+	/** Slack added to the capsule radius, for quantization and interpolation error */
+	UPROPERTY(Config)
+	float HitTolerance{15.f};
+
+	/** Furthest the claimed shot may start from the shooter's rewound location */
+	UPROPERTY(Config)
+	float MaxAimStartError{400.f};
+
+	/** Longest shot the server accepts */
+	UPROPERTY(Config)
+	float MaxShotRange{50'000.f};
+
+	/** MaxTrackedCharacters windows of HistoryLength samples */
+	TArray<FHitboxSample> Samples;
+
+	/** One entry per window */
+	TArray<FHitboxHistory> Histories;
+
+	/** Window of each tracked character */
+	TMap<const AShooterCharacter*, int32> SlotByCharacter;
+};
@@ -6,8 +6,8 @@
 // Sets default values
 AMyPawn::AMyPawn()
 {
- 	// Set this pawn to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Nothing to do per frame
+	PrimaryActorTick.bCanEverTick = false;
 
 }
 
@@ -18,13 +18,6 @@ void AMyPawn::BeginPlay()
 	
 }
 
-// Called every frame
-void AMyPawn::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-}
-
 // Called to bind functionality to input
 void AMyPawn::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
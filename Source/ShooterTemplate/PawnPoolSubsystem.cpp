@@ -0,0 +1,223 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PawnPoolSubsystem.h"
+
+#include "ShooterAIController.h"
+#include "ShooterCharacter.h"
+#include "ShooterTemplateGameModeBase.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+
+static FAutoConsoleCommandWithWorld PawnPoolStatsCommand(
+	TEXT("Shooter.PawnPool.Stats"),
+	TEXT("Log the pawn pool hit/miss counters and dormant characters for the current world."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		const UPawnPoolSubsystem* PawnPool = World ? World->GetSubsystem<UPawnPoolSubsystem>() : nullptr;
+		if (PawnPool)
+		{
+			const FPawnPoolStats& Stats = PawnPool->GetStats();
+			UE_LOG(LogTemp, Log, TEXT("Pawn pool: %d hits, %d misses, %d releases, %d prewarmed, %d dormant"),
+			       Stats.Hits, Stats.Misses, Stats.Releases, Stats.Prewarmed, PawnPool->GetNumDormant());
+		}
+	}));
+
+void UPawnPoolSubsystem::Deinitialize()
+{
+	// The world is going away with the pooled characters in it
+	Released.Reset();
+	Pools.Reset();
+	Super::Deinitialize();
+}
+
+void UPawnPoolSubsystem::PrewarmFromConfig()
+{
+	UWorld* World = GetWorld();
+	const FTransform DormantTransform(DormantLocation);
+	FActorSpawnParameters Params;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	for (const FPawnPoolPrewarm& Entry : Prewarm)
+	{
+		UClass* Class = Entry.Class.LoadSynchronous();
+		if (Class == nullptr)
+		{
+			continue;
+		}
+
+		for (int32 Count = 0; Count < Entry.Count; ++Count)
+		{
+			AShooterCharacter* Character = World->SpawnActor<AShooterCharacter>(Class, DormantTransform, Params);
+			if (Character == nullptr)
+			{
+				break;
+			}
+			if (Character->GetController() == nullptr)
+			{
+				Character->SpawnDefaultController();
+			}
+			if (AShooterAIController* AIController = Cast<AShooterAIController>(Character->GetController()))
+			{
+				AIController->SetDormant(true);
+			}
+
+			// Never in play, so a round reset leaves it dormant
+			Released.Add(Character);
+			MakeDormant(Character);
+			++Stats.Prewarmed;
+		}
+	}
+}
+
+AShooterCharacter* UPawnPoolSubsystem::AcquireCharacter(TSubclassOf<AShooterCharacter> Class, const FTransform& Transform)
+{
+	if (Class == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (FPawnPool* Pool = Pools.Find(Class))
+	{
+		while (Pool->Dormant.Num() > 0)
+		{
+			AShooterCharacter* Character = Pool->Dormant.Pop(false);
+			if (IsValid(Character))
+			{
+				++Stats.Hits;
+				Activate(Character, Transform);
+				return Character;
+			}
+		}
+	}
+
+	++Stats.Misses;
+	FActorSpawnParameters Params;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	AShooterCharacter* Character = GetWorld()->SpawnActor<AShooterCharacter>(Class, Transform, Params);
+	if (Character && Character->GetController() == nullptr)
+	{
+		Character->SpawnDefaultController();
+	}
+	return Character;
+}
+
+void UPawnPoolSubsystem::ReleaseCharacter(AShooterCharacter* Character, bool bDied)
+{
+	if (Character == nullptr || Character->IsPlayerControlled() || Released.Contains(Character))
+	{
+		return;
+	}
+
+	++Stats.Releases;
+	if (AShooterAIController* AIController = Cast<AShooterAIController>(Character->GetController()))
+	{
+		AIController->SetDormant(true);
+	}
+
+	FReleasedCharacter& Entry = Released.Add(Character);
+	Entry.bReturnOnRoundReset = bDied;
+	if (bDied && CorpseTime > 0.f)
+	{
+		const FTimerDelegate MakeDormantDelegate = FTimerDelegate::CreateUObject(
+			this, &UPawnPoolSubsystem::MakeDormant, TWeakObjectPtr<AShooterCharacter>(Character));
+		GetWorld()->GetTimerManager().SetTimer(Entry.DormantTimer, MakeDormantDelegate, CorpseTime, false);
+	}
+	else
+	{
+		MakeDormant(Character);
+	}
+}
+
+bool UPawnPoolSubsystem::ReturnToPlay(AShooterCharacter* Character)
+{
+	const FReleasedCharacter* Entry = Released.Find(Character);
+	if (Entry == nullptr || !Entry->bReturnOnRoundReset)
+	{
+		return false;
+	}
+
+	Activate(Character, Character->GetSpawnTransform());
+	return true;
+}
+
+void UPawnPoolSubsystem::ForgetCharacter(const AShooterCharacter* Character)
+{
+	FReleasedCharacter Entry;
+	if (!Released.RemoveAndCopyValue(Character, Entry))
+	{
+		return;
+	}
+
+	GetWorld()->GetTimerManager().ClearTimer(Entry.DormantTimer);
+	if (FPawnPool* Pool = Pools.Find(Character->GetClass()))
+	{
+		Pool->Dormant.RemoveSingleSwap(const_cast<AShooterCharacter*>(Character), false);
+	}
+}
+
+int32 UPawnPoolSubsystem::GetNumDormant() const
+{
+	int32 NumDormant = 0;
+	for (const TPair<UClass*, FPawnPool>& Pool : Pools)
+	{
+		NumDormant += Pool.Value.Dormant.Num();
+	}
+	return NumDormant;
+}
+
+void UPawnPoolSubsystem::MakeDormant(TWeakObjectPtr<AShooterCharacter> WeakCharacter)
+{
+	AShooterCharacter* Character = WeakCharacter.Get();
+	FReleasedCharacter* Entry = Character ? Released.Find(Character) : nullptr;
+	if (Entry == nullptr || Entry->bDormant)
+	{
+		return;
+	}
+
+	Entry->bDormant = true;
+	Character->SetDormant(true);
+	Character->TeleportTo(DormantLocation, FRotator::ZeroRotator, false, true);
+	Pools.FindOrAdd(Character->GetClass()).Dormant.Add(Character);
+
+	// Out of the match until it is acquired again
+	if (AShooterTemplateGameModeBase* GameMode = GetWorld()->GetAuthGameMode<AShooterTemplateGameModeBase>())
+	{
+		GameMode->PawnLeftMatch(Character);
+	}
+}
+
+void UPawnPoolSubsystem::Activate(AShooterCharacter* Character, const FTransform& Transform)
+{
+	FReleasedCharacter Entry;
+	if (Released.RemoveAndCopyValue(Character, Entry))
+	{
+		GetWorld()->GetTimerManager().ClearTimer(Entry.DormantTimer);
+		if (Entry.bDormant)
+		{
+			// Acquired characters were already popped
+			if (FPawnPool* Pool = Pools.Find(Character->GetClass()))
+			{
+				Pool->Dormant.RemoveSingleSwap(Character, false);
+			}
+		}
+	}
+
+	Character->SetDormant(false);
+	Character->ReviveAt(Transform);
+
+	if (AShooterAIController* AIController = Cast<AShooterAIController>(Character->GetController()))
+	{
+		AIController->SetDormant(false);
+		AIController->ResetRound();
+	}
+	else if (Character->GetController() == nullptr)
+	{
+		Character->SpawnDefaultController();
+	}
+
+	if (AShooterTemplateGameModeBase* GameMode = GetWorld()->GetAuthGameMode<AShooterTemplateGameModeBase>())
+	{
+		GameMode->PawnEnteredMatch(Character);
+	}
+}
@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PawnPoolSubsystem.generated.h"
+
+class AShooterCharacter;
+
+/** How many characters of a class to create dormant when the match starts */
+USTRUCT()
+struct FPawnPoolPrewarm
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Config)
+	TSoftClassPtr<AShooterCharacter> Class;
+
+	UPROPERTY(Config)
+	int32 Count{0};
+};
+
+/** Dormant characters of one class, ready to be handed out */
+USTRUCT()
+struct FPawnPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<AShooterCharacter*> Dormant;
+};
+
+/** Pool counters since the world started */
+USTRUCT(BlueprintType)
+struct FPawnPoolStats
+{
+	GENERATED_BODY()
+
+	/** Requests served by a dormant character */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = PawnPool)
+	int32 Hits{0};
+
+	/** Requests that had to spawn a new character */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = PawnPool)
+	int32 Misses{0};
+
+	/** Characters handed back to the pool */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = PawnPool)
+	int32 Releases{0};
+
+	/** Characters created dormant by PrewarmFromConfig */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = PawnPool)
+	int32 Prewarmed{0};
+};
+
+/**
+ * Reuses AI characters and their controllers instead of spawning them from scratch. A released character
+ * stays as a corpse for CorpseTime if it died, then goes dormant: hidden, without collision or tick, and
+ * with its behavior tree paused but its controller still possessing it. Acquiring one revives it at full
+ * health where it is needed. Player characters are never pooled. Server only.
+ */
+UCLASS(Config = Game)
+class SHOOTERTEMPLATE_API UPawnPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	virtual void Deinitialize() override;
+
+	/** Create the dormant characters listed in Prewarm. Called by the game mode when play begins */
+	void PrewarmFromConfig();
+
+	/**
+	 * Revive a dormant character of exactly this class at Transform, or spawn one if none is left
+	 * @return null only if the spawn failed
+	 */
+	UFUNCTION(BlueprintCallable, Category = PawnPool)
+	AShooterCharacter* AcquireCharacter(TSubclassOf<AShooterCharacter> Class, const FTransform& Transform);
+
+	/**
+	 * Hand a character back. Dead characters are brought back by the next round reset, live ones stay
+	 * dormant until acquired again. Does nothing for player characters or characters already released
+	 */
+	UFUNCTION(BlueprintCallable, Category = PawnPool)
+	void ReleaseCharacter(AShooterCharacter* Character, bool bDied);
+
+	/** True from ReleaseCharacter until the character is acquired or brought back */
+	FORCEINLINE bool IsReleased(const AShooterCharacter* Character) const { return Released.Contains(Character); }
+
+	/**
+	 * Bring a character that died this round back into play where it is, for a round reset
+	 * @return false if the character wasn't in play this round, and should stay dormant
+	 */
+	bool ReturnToPlay(AShooterCharacter* Character);
+
+	/** Drop a character that is leaving the world */
+	void ForgetCharacter(const AShooterCharacter* Character);
+
+	int32 GetNumDormant() const;
+
+	FORCEINLINE const FPawnPoolStats& GetStats() const { return Stats; }
+
+private:
+	struct FReleasedCharacter
+	{
+		/** Pending switch from corpse to dormant */
+		FTimerHandle DormantTimer;
+
+		bool bDormant{false};
+
+		/** Died in play, so a round reset revives it */
+		bool bReturnOnRoundReset{false};
+	};
+
+	/** Hide the character and put it in its class's pool */
+	void MakeDormant(TWeakObjectPtr<AShooterCharacter> WeakCharacter);
+
+	/** Take a released character out of the pool and give it back to its controller, alive at Transform */
+	void Activate(AShooterCharacter* Character, const FTransform& Transform);
+
+	UPROPERTY(Transient)
+	TMap<UClass*, FPawnPool> Pools;
+
+	/** Every released character, corpse or dormant */
+	TMap<const AShooterCharacter*, FReleasedCharacter> Released;
+
+	/** Characters to create dormant per class when play begins */
+	UPROPERTY(Config)
+	TArray<FPawnPoolPrewarm> Prewarm;
+
+	/** Seconds a dead character stays visible before going dormant */
+	UPROPERTY(Config)
+	float CorpseTime{5.f};
+
+	/** Dormant characters wait here, out of sight and away from the level's geometry */
+	UPROPERTY(Config)
+	FVector DormantLocation{0.f, 0.f, -100000.f};
+
+	FPawnPoolStats Stats;
+};
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PelletPattern.h"
+
+/** Well mixed bits for one draw of one pellet, identical on every platform */
+static uint32 HashPellet(uint32 Seed, uint32 Draw)
+{
+	uint32 Hash = Seed ^ (Draw * 0x9E3779B9u);
+	Hash ^= Hash >> 16;
+	Hash *= 0x7FEB352Du;
+	Hash ^= Hash >> 15;
+	Hash *= 0x846CA68Bu;
+	Hash ^= Hash >> 16;
+	return Hash;
+}
+
+/** [0, 1) from the top 24 bits, which a float holds exactly */
+static float ToUnitFloat(uint32 Bits)
+{
+	return (Bits >> 8) * (1.f / 16777216.f);
+}
+
+void FPelletPattern::Generate(uint32 Seed, int32 NumPellets, float HalfAngleDegrees, const FVector& AimDirection,
+                              FPelletDirections& OutDirections)
+{
+	OutDirections.Reset();
+	if (NumPellets <= 0)
+	{
+		return;
+	}
+
+	FVector Right;
+	FVector Up;
+	AimDirection.FindBestAxisVectors(Right, Up);
+	const float MaxOffset = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(HalfAngleDegrees, 0.f, 89.f)));
+
+	// Polar offsets on the plane one unit down the aim line, uniform over the disc. Padded to whole lanes
+	const int32 NumPadded = Align(NumPellets, 4);
+	TArray<float, TInlineAllocator<16>> Angles;
+	TArray<float, TInlineAllocator<16>> Radii;
+	Angles.SetNumUninitialized(NumPadded);
+	Radii.SetNumUninitialized(NumPadded);
+	for (int32 Pellet = 0; Pellet < NumPadded; ++Pellet)
+	{
+		Angles[Pellet] = (ToUnitFloat(HashPellet(Seed, 2 * Pellet)) * 2.f - 1.f) * PI;
+		Radii[Pellet] = MaxOffset * FMath::Sqrt(ToUnitFloat(HashPellet(Seed, 2 * Pellet + 1)));
+	}
+	Radii[0] = 0.f;
+
+	const VectorRegister AimX = VectorSetFloat1(AimDirection.X);
+	const VectorRegister AimY = VectorSetFloat1(AimDirection.Y);
+	const VectorRegister AimZ = VectorSetFloat1(AimDirection.Z);
+	const VectorRegister RightX = VectorSetFloat1(Right.X);
+	const VectorRegister RightY = VectorSetFloat1(Right.Y);
+	const VectorRegister RightZ = VectorSetFloat1(Right.Z);
+	const VectorRegister UpX = VectorSetFloat1(Up.X);
+	const VectorRegister UpY = VectorSetFloat1(Up.Y);
+	const VectorRegister UpZ = VectorSetFloat1(Up.Z);
+
+	OutDirections.SetNumUninitialized(NumPadded);
+	for (int32 Pellet = 0; Pellet < NumPadded; Pellet += 4)
+	{
+		const VectorRegister Angle = VectorLoad(Angles.GetData() + Pellet);
+		const VectorRegister Radius = VectorLoad(Radii.GetData() + Pellet);
+		VectorRegister Sin;
+		VectorRegister Cos;
+		VectorSinCos(&Sin, &Cos, &Angle);
+		const VectorRegister OffsetRight = VectorMultiply(Radius, Cos);
+		const VectorRegister OffsetUp = VectorMultiply(Radius, Sin);
+
+		float X[4];
+		float Y[4];
+		float Z[4];
+		VectorStore(VectorMultiplyAdd(OffsetRight, RightX, VectorMultiplyAdd(OffsetUp, UpX, AimX)), X);
+		VectorStore(VectorMultiplyAdd(OffsetRight, RightY, VectorMultiplyAdd(OffsetUp, UpY, AimY)), Y);
+		VectorStore(VectorMultiplyAdd(OffsetRight, RightZ, VectorMultiplyAdd(OffsetUp, UpZ, AimZ)), Z);
+
+		// An exact square root rather than the reciprocal estimate, which isn't the same on every CPU
+		for (int32 Lane = 0; Lane < 4; ++Lane)
+		{
+			const FVector Direction(X[Lane], Y[Lane], Z[Lane]);
+			OutDirections[Pellet + Lane] = Direction / FMath::Sqrt(Direction.SizeSquared());
+		}
+	}
+	OutDirections.SetNum(NumPellets, false);
+}
@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Pellet directions of one shot. Typical shotgun patterns never leave the inline storage */
+using FPelletDirections = TArray<FVector, TInlineAllocator<16>>;
+
+/**
+ * Seeded spread pattern of a multi-pellet shot. The pattern only depends on the seed, pellet count,
+ * spread and aim, so the server and every client replay the same pellets for the same shot. Offsets
+ * come from an integer hash, and directions are built four pellets at a time with vector ops. Nothing
+ * uses estimate instructions, whose results differ between CPUs.
+ */
+struct SHOOTERTEMPLATE_API FPelletPattern
+{
+	/**
+	 * Directions of NumPellets pellets, spread uniformly over a cone of HalfAngleDegrees around
+	 * AimDirection. Pellet 0 always flies down the aim line
+	 */
+	static void Generate(uint32 Seed, int32 NumPellets, float HalfAngleDegrees, const FVector& AimDirection,
+	                     FPelletDirections& OutDirections);
+};
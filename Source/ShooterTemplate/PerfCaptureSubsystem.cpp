@@ -0,0 +1,302 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PerfCaptureSubsystem.h"
+
+#include "AIController.h"
+#include "PawnPoolSubsystem.h"
+#include "ShooterCharacter.h"
+#include "Dom/JsonObject.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerStart.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "RenderCore.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+bool UPerfCaptureSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	// Matches both -PerfCapture and -PerfCapture=Name
+	FString Name;
+	return FParse::Param(FCommandLine::Get(), TEXT("PerfCapture")) ||
+		FParse::Value(FCommandLine::Get(), TEXT("PerfCapture="), Name);
+}
+
+void UPerfCaptureSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	if (!FParse::Value(CommandLine, TEXT("PerfCapture="), CaptureName))
+	{
+		// Bare -PerfCapture is named after the map, so it picks up that map's baseline
+		CaptureName = UWorld::RemovePIEPrefix(GetWorld()->GetMapName());
+	}
+	FParse::Value(CommandLine, TEXT("PerfBots="), NumBots);
+	FParse::Value(CommandLine, TEXT("PerfWarmup="), WarmupTime);
+	FParse::Value(CommandLine, TEXT("PerfDuration="), CaptureTime);
+	bUpdateBaseline = FParse::Param(CommandLine, TEXT("PerfUpdateBaseline"));
+
+	PreGarbageCollectHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddUObject(
+		this, &UPerfCaptureSubsystem::OnPreGarbageCollect);
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(
+		this, &UPerfCaptureSubsystem::OnPostGarbageCollect);
+}
+
+void UPerfCaptureSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGarbageCollectHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	Super::Deinitialize();
+}
+
+void UPerfCaptureSubsystem::Tick(float DeltaTime)
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (!bStarted)
+	{
+		bStarted = true;
+		StartTime = Now;
+		LastGarbageCollectionTime = Now;
+		SpawnBots();
+		UE_LOG(LogTemp, Log, TEXT("PerfCapture %s: %d bots, %.0fs warmup, %.0fs capture"), *CaptureName,
+		       Bots.Num(), WarmupTime, CaptureTime);
+		return;
+	}
+
+	DriveBots(Now);
+
+	const double Elapsed = Now - StartTime;
+	if (Elapsed < WarmupTime)
+	{
+		return;
+	}
+
+	RecordFrame(DeltaTime);
+	if (ForceGarbageCollectionInterval > 0.f && Now - LastGarbageCollectionTime >= ForceGarbageCollectionInterval)
+	{
+		LastGarbageCollectionTime = Now;
+		GEngine->ForceGarbageCollection(true);
+	}
+
+	if (Elapsed >= WarmupTime + CaptureTime)
+	{
+		bFinished = true;
+		const bool bPassed = Finish();
+		FPlatformMisc::RequestExitWithStatus(false, bPassed ? 0 : 1);
+	}
+}
+
+bool UPerfCaptureSubsystem::IsTickable() const
+{
+	return !IsTemplate() && !bFinished && GetWorld()->IsGameWorld() && GetWorld()->HasBegunPlay();
+}
+
+TStatId UPerfCaptureSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPerfCaptureSubsystem, STATGROUP_Tickables);
+}
+
+void UPerfCaptureSubsystem::SpawnBots()
+{
+	Bots.SetNum(NumBots);
+	NextShotTimes.SetNum(NumBots);
+	for (int32 BotIndex = 0; BotIndex < NumBots; ++BotIndex)
+	{
+		Bots[BotIndex] = SpawnBot(BotIndex);
+
+		// Staggered so the bots don't all fire on the same frame
+		NextShotTimes[BotIndex] = BotFireInterval * BotIndex / FMath::Max(NumBots, 1);
+	}
+}
+
+AShooterCharacter* UPerfCaptureSubsystem::SpawnBot(int32 BotIndex)
+{
+	UWorld* World = GetWorld();
+	UClass* Class = BotClass.LoadSynchronous();
+	if (Class == nullptr)
+	{
+		const AGameModeBase* GameMode = World->GetAuthGameMode();
+		Class = GameMode ? GameMode->DefaultPawnClass.Get() : nullptr;
+	}
+	if (Class == nullptr || !Class->IsChildOf(AShooterCharacter::StaticClass()))
+	{
+		UE_LOG(LogTemp, Error, TEXT("PerfCapture: no AShooterCharacter class to spawn bots from"));
+		return nullptr;
+	}
+
+	FVector Center = FVector::ZeroVector;
+	for (TActorIterator<APlayerStart> It(World); It; ++It)
+	{
+		Center = It->GetActorLocation();
+		break;
+	}
+
+	// Spread on a circle, facing the middle
+	const float Angle = 2.f * PI * BotIndex / FMath::Max(NumBots, 1);
+	const FVector Offset{FMath::Cos(Angle) * SpawnRadius, FMath::Sin(Angle) * SpawnRadius, 0.f};
+	UPawnPoolSubsystem* PawnPool = World->GetSubsystem<UPawnPoolSubsystem>();
+	return PawnPool ? PawnPool->AcquireCharacter(Class, FTransform((-Offset).Rotation(), Center + Offset)) : nullptr;
+}
+
+void UPerfCaptureSubsystem::DriveBots(double Now)
+{
+	for (int32 BotIndex = 0; BotIndex < Bots.Num(); ++BotIndex)
+	{
+		AShooterCharacter* Bot = Bots[BotIndex].Get();
+		if (Bot == nullptr || Bot->IsDead())
+		{
+			// Keep the load constant by replacing the dead. The pawn pool already has the corpse
+			Bots[BotIndex] = SpawnBot(BotIndex);
+			continue;
+		}
+
+		if (Now < NextShotTimes[BotIndex])
+		{
+			continue;
+		}
+		NextShotTimes[BotIndex] = Now + BotFireInterval;
+
+		// Shoot at the bot across the circle
+		AShooterCharacter* Target = Bots[(BotIndex + Bots.Num() / 2) % Bots.Num()].Get();
+		AAIController* Controller = Cast<AAIController>(Bot->GetController());
+		if (Target == nullptr || Target == Bot || Controller == nullptr)
+		{
+			continue;
+		}
+
+		// Bots aim from their eyes along the control rotation. It is turned now for this shot, and the focus
+		// keeps it on the target between shots
+		Controller->SetFocus(Target);
+		Controller->SetControlRotation((Target->GetActorLocation() - Bot->GetPawnViewLocation()).Rotation());
+
+		// A tap, so every fire mode gets one trigger pull per interval, at the weapon's own rate and damage
+		Bot->PullTrigger();
+		Bot->ReleaseTrigger();
+	}
+}
+
+void UPerfCaptureSubsystem::RecordFrame(float DeltaTime)
+{
+	FrameTimes.Add(DeltaTime * 1000.f);
+	GameThreadTimes.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+}
+
+bool UPerfCaptureSubsystem::Finish()
+{
+	auto Average = [](const TArray<float>& Samples)
+	{
+		double Sum = 0.0;
+		for (const float Sample : Samples)
+		{
+			Sum += Sample;
+		}
+		return Samples.Num() > 0 ? Sum / Samples.Num() : 0.0;
+	};
+	auto Percentile = [](TArray<float> Samples, float Fraction)
+	{
+		if (Samples.Num() == 0)
+		{
+			return 0.0;
+		}
+		Samples.Sort();
+		return static_cast<double>(Samples[FMath::Min(FMath::FloorToInt(Samples.Num() * Fraction), Samples.Num() - 1)]);
+	};
+
+	// Every metric is lower-is-better, so one tolerance rule covers them all
+	TSharedRef<FJsonObject> Metrics = MakeShared<FJsonObject>();
+	Metrics->SetNumberField(TEXT("FrameTimeAvgMs"), Average(FrameTimes));
+	Metrics->SetNumberField(TEXT("FrameTimeP95Ms"), Percentile(FrameTimes, 0.95f));
+	Metrics->SetNumberField(TEXT("GameThreadAvgMs"), Average(GameThreadTimes));
+	Metrics->SetNumberField(TEXT("GameThreadP95Ms"), Percentile(GameThreadTimes, 0.95f));
+	Metrics->SetNumberField(TEXT("PeakUsedPhysicalMB"), FPlatformMemory::GetStats().PeakUsedPhysical / (1024.0 * 1024.0));
+	Metrics->SetNumberField(TEXT("GarbageCollectTotalMs"), TotalGarbageCollectTime * 1000.0);
+	Metrics->SetNumberField(TEXT("GarbageCollectMaxMs"), MaxGarbageCollectTime * 1000.0);
+
+	TSharedRef<FJsonObject> Results = MakeShared<FJsonObject>();
+	Results->SetStringField(TEXT("Name"), CaptureName);
+	Results->SetStringField(TEXT("Map"), GetWorld()->GetMapName());
+	Results->SetNumberField(TEXT("Bots"), NumBots);
+	Results->SetNumberField(TEXT("Frames"), FrameTimes.Num());
+	Results->SetNumberField(TEXT("GarbageCollections"), NumGarbageCollections);
+	Results->SetObjectField(TEXT("Metrics"), Metrics);
+
+	FString Json;
+	FJsonSerializer::Serialize(Results, TJsonWriterFactory<>::Create(&Json));
+	const FString ResultsPath = FPaths::ProjectSavedDir() / TEXT("PerfCapture") / CaptureName + TEXT(".json");
+	const FString BaselinePath = FPaths::ProjectDir() / BaselineDirectory / CaptureName + TEXT(".json");
+	FFileHelper::SaveStringToFile(Json, *ResultsPath);
+	UE_LOG(LogTemp, Log, TEXT("PerfCapture %s: results written to %s"), *CaptureName, *ResultsPath);
+
+	if (bUpdateBaseline)
+	{
+		FFileHelper::SaveStringToFile(Json, *BaselinePath);
+		UE_LOG(LogTemp, Log, TEXT("PerfCapture %s: baseline updated"), *CaptureName);
+		return true;
+	}
+
+	FString BaselineJson;
+	TSharedPtr<FJsonObject> Baseline;
+	if (!FFileHelper::LoadFileToString(BaselineJson, *BaselinePath) ||
+		!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(BaselineJson), Baseline) || !Baseline.IsValid())
+	{
+		// A run with nothing to compare against would pass silently, so a missing baseline fails it
+		UE_LOG(LogTemp, Error, TEXT("PerfCapture %s: no readable baseline at %s. Run with -PerfUpdateBaseline to create it"),
+		       *CaptureName, *BaselinePath);
+		return false;
+	}
+
+	const TSharedPtr<FJsonObject>* BaselineMetrics;
+	if (!Baseline->TryGetObjectField(TEXT("Metrics"), BaselineMetrics))
+	{
+		UE_LOG(LogTemp, Error, TEXT("PerfCapture %s: baseline %s has no Metrics"), *CaptureName, *BaselinePath);
+		return false;
+	}
+
+	bool bPassed = true;
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Metric : Metrics->Values)
+	{
+		// A baseline without the metric can't vouch for it, so it fails like a regression
+		double BaselineValue;
+		if (!(*BaselineMetrics)->TryGetNumberField(Metric.Key, BaselineValue))
+		{
+			UE_LOG(LogTemp, Error, TEXT("PerfCapture %s: baseline %s has no %s. Run with -PerfUpdateBaseline to record it"),
+			       *CaptureName, *BaselinePath, *Metric.Key);
+			bPassed = false;
+			continue;
+		}
+		const double Value = Metric.Value->AsNumber();
+		const double Limit = BaselineValue * (1.0 + RegressionTolerance);
+		if (Value > Limit)
+		{
+			UE_LOG(LogTemp, Error, TEXT("PerfCapture %s: %s regressed, %.2f over limit %.2f (baseline %.2f)"),
+			       *CaptureName, *Metric.Key, Value, Limit, BaselineValue);
+			bPassed = false;
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("PerfCapture %s: %s"), *CaptureName, bPassed ? TEXT("passed") : TEXT("FAILED"));
+	return bPassed;
+}
+
+void UPerfCaptureSubsystem::OnPreGarbageCollect()
+{
+	GarbageCollectStartTime = FPlatformTime::Seconds();
+}
+
+void UPerfCaptureSubsystem::OnPostGarbageCollect()
+{
+	// Only GCs during the capture window count
+	if (!bStarted || bFinished || GetWorld()->GetTimeSeconds() - StartTime < WarmupTime)
+	{
+		return;
+	}
+	const double Duration = FPlatformTime::Seconds() - GarbageCollectStartTime;
+	TotalGarbageCollectTime += Duration;
+	MaxGarbageCollectTime = FMath::Max(MaxGarbageCollectTime, Duration);
+	++NumGarbageCollections;
+}
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "PerfCaptureSubsystem.generated.h"
+
+class AShooterCharacter;
+
+/**
+ * Headless performance run, enabled with -PerfCapture[=Name] on the command line, e.g.
+ *   ShooterTemplate Sandbox -game -nullrhi -unattended -PerfCapture -PerfBots=64 -PerfDuration=30
+ * Spawns AI controlled bots that keep firing their weapons at each other, records frame time, game thread
+ * time, peak memory and GC time, writes them as JSON to Saved/PerfCapture and compares them with the
+ * baseline of the same name. The name defaults to the map's. The process exits with a non-zero code when
+ * a metric is over its baseline tolerance, or there is no baseline to compare with.
+ * -PerfUpdateBaseline stores the results as the new baseline instead.
+ */
+UCLASS(Config = Game)
+class SHOOTERTEMPLATE_API UPerfCaptureSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+private:
+	void SpawnBots();
+	AShooterCharacter* SpawnBot(int32 BotIndex);
+
+	/** Every bot whose shot is due aims at another bot and pulls the trigger. Dead bots are replaced */
+	void DriveBots(double Now);
+
+	void RecordFrame(float DeltaTime);
+
+	/** Write the results and compare them with the baseline. Returns false on a regression */
+	bool Finish();
+
+	void OnPreGarbageCollect();
+	void OnPostGarbageCollect();
+
+	/** Spawned for each bot. Falls back to the game mode's default pawn class when unset */
+	UPROPERTY(Config)
+	TSoftClassPtr<AShooterCharacter> BotClass;
+
+	/** Bots are spread on a circle of this radius around the first player start */
+	UPROPERTY(Config)
+	float SpawnRadius{2000.f};
+
+	/** Seconds between trigger pulls of each bot. The weapon's rate of fire still applies */
+	UPROPERTY(Config)
+	float BotFireInterval{0.1f};
+
+	/** Forced full GC interval during the capture, so every run measures some GC. Zero leaves GC alone */
+	UPROPERTY(Config)
+	float ForceGarbageCollectionInterval{10.f};
+
+	/** Metrics may exceed their baseline by this fraction before the run fails */
+	UPROPERTY(Config)
+	float RegressionTolerance{0.15f};
+
+	/** Baselines are read from here, relative to the project directory */
+	UPROPERTY(Config)
+	FString BaselineDirectory{TEXT("Build/PerfBaselines")};
+
+	/** Settings read from the command line */
+	FString CaptureName;
+	int32 NumBots{32};
+	float WarmupTime{5.f};
+	float CaptureTime{30.f};
+	bool bUpdateBaseline{false};
+
+	TArray<TWeakObjectPtr<AShooterCharacter>> Bots;
+	TArray<double> NextShotTimes;
+
+	bool bStarted{false};
+	bool bFinished{false};
+	double StartTime{0.0};
+	double LastGarbageCollectionTime{0.0};
+
+	/** Per-frame samples taken after warmup, in milliseconds */
+	TArray<float> FrameTimes;
+	TArray<float> GameThreadTimes;
+
+	double GarbageCollectStartTime{0.0};
+	double TotalGarbageCollectTime{0.0};
+	double MaxGarbageCollectTime{0.0};
+	int32 NumGarbageCollections{0};
+
+	FDelegateHandle PreGarbageCollectHandle;
+	FDelegateHandle PostGarbageCollectHandle;
+};
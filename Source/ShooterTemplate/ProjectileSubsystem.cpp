@@ -0,0 +1,231 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ProjectileSubsystem.h"
+
+#include "DamageQueueSubsystem.h"
+#include "FXPoolSubsystem.h"
+#include "GameplayEventBus.h"
+#include "ShooterTemplate.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+
+void UProjectileSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Reserve everything once so spawning a round never allocates
+	Positions.Reserve(MaxProjectiles);
+	Velocities.Reserve(MaxProjectiles);
+	Ages.Reserve(MaxProjectiles);
+	Damages.Reserve(MaxProjectiles);
+	ExplosionRadii.Reserve(MaxProjectiles);
+	ExplosionInnerRadii.Reserve(MaxProjectiles);
+	Owners.Reserve(MaxProjectiles);
+	DamageCausers.Reserve(MaxProjectiles);
+	Instigators.Reserve(MaxProjectiles);
+	ImpactEffects.Reserve(MaxProjectiles);
+	PreviousPositions.Reserve(MaxProjectiles);
+	IgnoredActors.Reserve(MaxProjectiles);
+	StepHits.Reserve(MaxProjectiles);
+	StepHitFlags.Reserve(MaxProjectiles);
+}
+
+void UProjectileSubsystem::Deinitialize()
+{
+	ClearProjectiles();
+	Super::Deinitialize();
+}
+
+bool UProjectileSubsystem::SpawnProjectile(const FProjectileSpawnParams& Params)
+{
+	if (Positions.Num() >= MaxProjectiles)
+	{
+		return false;
+	}
+
+	if (Positions.Num() == 0)
+	{
+		TimeAccumulator = 0.f;
+	}
+
+	Positions.Add(Params.Location);
+	Velocities.Add(Params.Velocity);
+	Ages.Add(0.f);
+	Damages.Add(Params.Damage);
+	ExplosionRadii.Add(Params.ExplosionRadius);
+	ExplosionInnerRadii.Add(Params.ExplosionInnerRadius);
+	Owners.Add(Params.Owner);
+	DamageCausers.Add(Params.DamageCauser);
+	Instigators.Add(Params.Instigator);
+	ImpactEffects.Add(Params.ImpactEffect);
+	return true;
+}
+
+void UProjectileSubsystem::ClearProjectiles()
+{
+	Positions.Reset();
+	Velocities.Reset();
+	Ages.Reset();
+	Damages.Reset();
+	ExplosionRadii.Reset();
+	ExplosionInnerRadii.Reset();
+	Owners.Reset();
+	DamageCausers.Reset();
+	Instigators.Reset();
+	ImpactEffects.Reset();
+	PendingHits.Reset();
+}
+
+void UProjectileSubsystem::Tick(float DeltaTime)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterProjectiles);
+	const float StepTime = 1.f / SubstepRate;
+	TimeAccumulator += DeltaTime;
+
+	int32 Steps = 0;
+	while (TimeAccumulator >= StepTime && Steps < MaxSubstepsPerFrame && Positions.Num() > 0)
+	{
+		Step(StepTime);
+		TimeAccumulator -= StepTime;
+		++Steps;
+	}
+
+	// Don't try to catch up after a hitch
+	TimeAccumulator = FMath::Min(TimeAccumulator, StepTime);
+}
+
+bool UProjectileSubsystem::IsTickable() const
+{
+	return !IsTemplate() && Positions.Num() > 0;
+}
+
+TStatId UProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileSubsystem, STATGROUP_Tickables);
+}
+
+void UProjectileSubsystem::Step(float StepTime)
+{
+	UWorld* World = GetWorld();
+	const int32 Num = Positions.Num();
+	const FVector Gravity{0.f, 0.f, World->GetGravityZ()};
+
+	PreviousPositions.SetNumUninitialized(Num, false);
+	IgnoredActors.SetNumUninitialized(Num, false);
+	StepHits.SetNum(Num, false);
+	StepHitFlags.SetNumZeroed(Num, false);
+
+	// Weak pointers are resolved here, workers only see raw pointers
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		IgnoredActors[Index] = Owners[Index].Get();
+	}
+
+	// Integrate with ballistic drop
+	ParallelFor(Num, [this, &Gravity, StepTime](int32 Index)
+	{
+		PreviousPositions[Index] = Positions[Index];
+		Velocities[Index] += Gravity * StepTime;
+		Positions[Index] += Velocities[Index] * StepTime;
+		Ages[Index] += StepTime;
+	});
+
+	// Sweep the segment each round covered this step
+	SHOOTER_INC_COUNTER(STAT_ShooterTraces, Num);
+	UGameplayEventBus* EventBus = World->GetSubsystem<UGameplayEventBus>();
+	ParallelFor(Num, [this, World, EventBus](int32 Index)
+	{
+		const FCollisionQueryParams Params(SCENE_QUERY_STAT(ProjectileSweep), false, IgnoredActors[Index]);
+		StepHitFlags[Index] = World->LineTraceSingleByChannel(StepHits[Index], PreviousPositions[Index], Positions[Index],
+		                                                      ECollisionChannel::ECC_GameTraceChannel1, Params);
+
+		// Only impacts. A shot event per round per step would flood the bus
+		if (StepHitFlags[Index] && EventBus)
+		{
+			FShooterShotEvent Event;
+			Event.Shooter = Owners[Index];
+			Event.Start = PreviousPositions[Index];
+			Event.End = StepHits[Index].ImpactPoint;
+			Event.HitActor = StepHits[Index].Actor;
+			Event.bHit = true;
+			Event.bProjectile = true;
+			EventBus->Publish(Event);
+		}
+	});
+
+	// Take finished rounds out first, so damage handlers can safely spawn new ones
+	PendingHits.Reset();
+	for (int32 Index = Num - 1; Index >= 0; --Index)
+	{
+		if (StepHitFlags[Index])
+		{
+			FProjectileHit& Pending = PendingHits.AddDefaulted_GetRef();
+			Pending.Hit = StepHits[Index];
+			Pending.Direction = Velocities[Index].GetSafeNormal();
+			Pending.Damage = Damages[Index];
+			Pending.ExplosionRadius = ExplosionRadii[Index];
+			Pending.ExplosionInnerRadius = ExplosionInnerRadii[Index];
+			Pending.DamageCauser = DamageCausers[Index];
+			Pending.Instigator = Instigators[Index];
+			Pending.ImpactEffect = ImpactEffects[Index];
+			RemoveProjectile(Index);
+		}
+		else if (Ages[Index] >= MaxLifetime)
+		{
+			RemoveProjectile(Index);
+		}
+	}
+
+	// Clients' rounds are only for show. The server simulates its own copy of every round, and deals the damage
+	UFXPoolSubsystem* FXPool = World->GetSubsystem<UFXPoolSubsystem>();
+	UDamageQueueSubsystem* DamageQueue = World->GetSubsystem<UDamageQueueSubsystem>();
+	const bool bDealDamage = !World->IsNetMode(NM_Client);
+	for (const FProjectileHit& Pending : PendingHits)
+	{
+		if (FXPool && Pending.ImpactEffect)
+		{
+			FXPool->SpawnAtLocation(Pending.ImpactEffect, Pending.Hit.ImpactPoint, (-Pending.Direction).Rotation());
+		}
+		if (!bDealDamage)
+		{
+			continue;
+		}
+
+		// Explosions damage everything around the impact that the level doesn't shield
+		if (Pending.ExplosionRadius > 0.f)
+		{
+			if (DamageQueue && Pending.Damage > 0.f)
+			{
+				const FRadialDamageParams Explosion(Pending.Damage, 0.f, Pending.ExplosionInnerRadius,
+				                                    Pending.ExplosionRadius, 1.f);
+				DamageQueue->ApplyRadialDamage(Pending.Hit.ImpactPoint + Pending.Hit.ImpactNormal, Explosion,
+				                               Pending.Instigator.Get(), Pending.DamageCauser.Get());
+			}
+			continue;
+		}
+
+		// Deal Damage to Actor
+		AActor* HitActor = Pending.Hit.GetActor();
+		if (HitActor != nullptr && Pending.Damage > 0.f)
+		{
+			FPointDamageEvent DamageEvent(Pending.Damage, Pending.Hit, Pending.Direction, nullptr);
+			HitActor->TakeDamage(Pending.Damage, DamageEvent, Pending.Instigator.Get(), Pending.DamageCauser.Get());
+		}
+	}
+}
+
+void UProjectileSubsystem::RemoveProjectile(int32 Index)
+{
+	Positions.RemoveAtSwap(Index, 1, false);
+	Velocities.RemoveAtSwap(Index, 1, false);
+	Ages.RemoveAtSwap(Index, 1, false);
+	Damages.RemoveAtSwap(Index, 1, false);
+	ExplosionRadii.RemoveAtSwap(Index, 1, false);
+	ExplosionInnerRadii.RemoveAtSwap(Index, 1, false);
+	Owners.RemoveAtSwap(Index, 1, false);
+	DamageCausers.RemoveAtSwap(Index, 1, false);
+	Instigators.RemoveAtSwap(Index, 1, false);
+	ImpactEffects.RemoveAtSwap(Index, 1, false);
+}
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ProjectileSubsystem.generated.h"
+
+class UParticleSystem;
+
+/** Everything needed to put a round in flight */
+struct FProjectileSpawnParams
+{
+	FVector Location{FVector::ZeroVector};
+	FVector Velocity{FVector::ZeroVector};
+
+	/** Pawn that fired the round. Its collision is ignored */
+	AActor* Owner{nullptr};
+
+	/** Passed to TakeDamage as the damage causer */
+	AActor* DamageCauser{nullptr};
+
+	/** Passed to TakeDamage as the instigator */
+	AController* Instigator{nullptr};
+
+	float Damage{0.f};
+
+	/** Rounds with a radius explode where they hit, and Damage falls off to nothing at the radius */
+	float ExplosionRadius{0.f};
+
+	/** Full damage within this distance of an explosion */
+	float ExplosionInnerRadius{0.f};
+
+	/** Spawned through the FX pool where the round hits. Optional */
+	UParticleSystem* ImpactEffect{nullptr};
+};
+
+/**
+ * Simulates every bullet in the world with travel time and drop, without an actor per bullet.
+ * Live rounds are kept in parallel arrays, integrated with a ParallelFor at a fixed sub-step and swept
+ * against the Bullet channel in a second ParallelFor. Hits are then applied on the game thread through
+ * TakeDamage, or as radial damage for rounds that explode. Like hitscan shots, rounds never deal damage on
+ * clients: a remote client's rounds are simulated again on the server, from the shot it announced.
+ */
+UCLASS(Config = Game)
+class SHOOTERTEMPLATE_API UProjectileSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Put a round in flight. Returns false when MaxProjectiles are already live */
+	bool SpawnProjectile(const FProjectileSpawnParams& Params);
+
+	/** Remove every live round without applying hits */
+	void ClearProjectiles();
+
+	FORCEINLINE int32 GetNumProjectiles() const { return Positions.Num(); }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+private:
+	/** Advance every round by one fixed sub-step and apply its hits */
+	void Step(float StepTime);
+
+	void RemoveProjectile(int32 Index);
+
+	/** Fixed simulation rate, in steps per second */
+	UPROPERTY(Config)
+	float SubstepRate{120.f};
+
+	/** Time beyond this many sub-steps in one frame is dropped */
+	UPROPERTY(Config)
+	int32 MaxSubstepsPerFrame{8};
+
+	/** Buffers are reserved for this many rounds up front */
+	UPROPERTY(Config)
+	int32 MaxProjectiles{4096};
+
+	/** Rounds that haven't hit anything after this many seconds are removed */
+	UPROPERTY(Config)
+	float MaxLifetime{3.f};
+
+	/** Live rounds, one entry per array at the same index */
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<float> Ages;
+	TArray<float> Damages;
+	TArray<float> ExplosionRadii;
+	TArray<float> ExplosionInnerRadii;
+	TArray<TWeakObjectPtr<AActor>> Owners;
+	TArray<TWeakObjectPtr<AActor>> DamageCausers;
+	TArray<TWeakObjectPtr<AController>> Instigators;
+
+	UPROPERTY(Transient)
+	TArray<UParticleSystem*> ImpactEffects;
+
+	/** Per-step scratch, sized with the rounds and reused */
+	TArray<FVector> PreviousPositions;
+	TArray<const AActor*> IgnoredActors;
+	TArray<FHitResult> StepHits;
+	TArray<uint8> StepHitFlags;
+
+	/** A hit taken out of the buffers, waiting for TakeDamage */
+	struct FProjectileHit
+	{
+		FHitResult Hit;
+		FVector Direction;
+		float Damage;
+		float ExplosionRadius;
+		float ExplosionInnerRadius;
+		TWeakObjectPtr<AActor> DamageCauser;
+		TWeakObjectPtr<AController> Instigator;
+		UParticleSystem* ImpactEffect;
+	};
+	TArray<FProjectileHit> PendingHits;
+
+	/** Simulation time not yet consumed by a sub-step */
+	float TimeAccumulator{0.f};
+};
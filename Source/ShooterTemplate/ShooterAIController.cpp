@@ -3,8 +3,12 @@
 
 #include "ShooterAIController.h"
 
+#include "AISignificanceSubsystem.h"
+#include "BrainComponent.h"
+#include "ShooterCharacter.h"
+#include "SpatialHashSubsystem.h"
 #include "BehaviorTree/BlackboardComponent.h"
-#include "Kismet/GameplayStatics.h"
+#include "BehaviorTree/BlackboardData.h"
 
 void AShooterAIController::BeginPlay()
 {
@@ -13,12 +17,81 @@ void AShooterAIController::BeginPlay()
 	if (AIBehavior!=nullptr)
 	{
 		RunBehaviorTree(AIBehavior);
-		APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(GetWorld(), 0);
 		GetBlackboardComponent()->SetValueAsVector(TEXT("StartLocation"), GetPawn()->GetActorLocation());
 	}
+
+	if (UAISignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UAISignificanceSubsystem>())
+	{
+		Significance->RegisterController(this);
+	}
+}
+
+void AShooterAIController::ResetRound()
+{
+	UBlackboardComponent* Blackboard = GetBlackboardComponent();
+	if (bDormant || AIBehavior == nullptr || Blackboard == nullptr || GetPawn() == nullptr)
+	{
+		return;
+	}
+
+	// Running the same tree again keeps the blackboard, so clear what the last round wrote
+	if (const UBlackboardData* BlackboardAsset = Blackboard->GetBlackboardAsset())
+	{
+		for (FBlackboard::FKey Key = 0; Key < BlackboardAsset->GetNumKeys(); ++Key)
+		{
+			Blackboard->ClearValue(Key);
+		}
+	}
+	Blackboard->SetValueAsVector(TEXT("StartLocation"), GetPawn()->GetActorLocation());
+
+	if (BrainComponent)
+	{
+		BrainComponent->RestartLogic();
+	}
 }
-void AShooterAIController::Tick(float DeltaSeconds)
+
+void AShooterAIController::FindTargets(int32 MaxTargets, TArray<AActor*>& OutTargets) const
+{
+	const USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>();
+	const APawn* ControlledPawn = GetPawn();
+	if (SpatialHash == nullptr || ControlledPawn == nullptr)
+	{
+		return;
+	}
+
+	SpatialHash->QueryNearest(ControlledPawn->GetActorLocation(), TargetSearchRadius, MaxTargets, OutTargets,
+	                          [ControlledPawn](const AActor* Actor)
+	                          {
+		                          const AShooterCharacter* Character = Cast<AShooterCharacter>(Actor);
+		                          return Character && Character != ControlledPawn &&
+			                          Character->IsPlayerControlled() && !Character->IsDead();
+	                          });
+}
+
+void AShooterAIController::SetDormant(bool bNewDormant)
 {
-	Super::Tick(DeltaSeconds);
+	bDormant = bNewDormant;
+	StopMovement();
+	SetActorTickEnabled(!bDormant);
+	if (BrainComponent)
+	{
+		if (bDormant)
+		{
+			BrainComponent->PauseLogic(TEXT("Dormant"));
+		}
+		else
+		{
+			BrainComponent->ResumeLogic(TEXT("Dormant"));
+		}
+	}
+}
+
+void AShooterAIController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UAISignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UAISignificanceSubsystem>())
+	{
+		Significance->UnregisterController(this);
+	}
+	Super::EndPlay(EndPlayReason);
 }
 
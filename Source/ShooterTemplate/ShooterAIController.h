@@ -14,11 +14,28 @@ class SHOOTERTEMPLATE_API AShooterAIController : public AAIController
 {
 	GENERATED_BODY()
 public:
-	virtual void Tick(float DeltaSeconds) override;
+	/** Clear the blackboard and restart the behavior tree from the pawn's current location */
+	void ResetRound();
+
+	/** Pause the behavior tree and stop ticking while the pawn waits in the pawn pool */
+	void SetDormant(bool bNewDormant);
+
+	FORCEINLINE bool IsDormant() const { return bDormant; }
+
+	/** Up to MaxTargets live player-controlled characters within TargetSearchRadius, nearest first */
+	void FindTargets(int32 MaxTargets, TArray<AActor*>& OutTargets) const;
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 private:
 	UPROPERTY(EditAnywhere)
 	class UBehaviorTree* AIBehavior;
+
+	/** Players further away than this are never targeted */
+	UPROPERTY(EditAnywhere)
+	float TargetSearchRadius{50000.f};
+
+	bool bDormant{false};
 };
@@ -4,9 +4,28 @@
 #include "ShooterAnimInstance.h"
 
 #include "ShooterCharacter.h"
+#include "ShooterTemplate.h"
 #include "GameFramework/CharacterMovementComponent.h"
-#include "GameFramework/PawnMovementComponent.h"
-#include "Kismet/KismetMathLibrary.h"
+
+void FShooterAnimInstanceProxy::Initialize(UAnimInstance* InAnimInstance)
+{
+	FAnimInstanceProxy::Initialize(InAnimInstance);
+	ShooterAnimInstance = CastChecked<UShooterAnimInstance>(InAnimInstance);
+}
+
+void FShooterAnimInstanceProxy::PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds)
+{
+	FAnimInstanceProxy::PreUpdate(InAnimInstance, DeltaSeconds);
+	ShooterAnimInstance->GatherSnapshot(Snapshot);
+}
+
+void FShooterAnimInstanceProxy::Update(float DeltaSeconds)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterAnimUpdate);
+	// The game thread leaves the instance's properties alone until the parallel update completes
+	ShooterAnimInstance->UpdateFromSnapshot(Snapshot);
+	FAnimInstanceProxy::Update(DeltaSeconds);
+}
 
 UShooterAnimInstance::UShooterAnimInstance() :
 WalkingBlendWeight(.7f),
@@ -15,55 +34,71 @@ AimingBlendWeight(1.f)
 }
 
 void UShooterAnimInstance::UpdateAnimationProperties(float DeltaTime)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterAnimUpdate);
+	FShooterAnimSnapshot Snapshot;
+	GatherSnapshot(Snapshot);
+	UpdateFromSnapshot(Snapshot);
+}
+
+void UShooterAnimInstance::NativeInitializeAnimation()
+{
+	ShooterCharacter = Cast<AShooterCharacter>(TryGetPawnOwner());
+}
+
+void UShooterAnimInstance::GatherSnapshot(FShooterAnimSnapshot& OutSnapshot)
 {
 	if (ShooterCharacter == nullptr)
 	{
 		ShooterCharacter = Cast<AShooterCharacter>(TryGetPawnOwner());
 	}
 
+	OutSnapshot.bHasCharacter = ShooterCharacter != nullptr;
 	if (ShooterCharacter)
 	{
-		// Get the lateral speed of character from velocity
-		FVector Velocity{ShooterCharacter->GetVelocity()};
-		Velocity.Z = 0.f;
-		Speed = Velocity.Size();
-
-		// Is the character in the air
-		bIsInAir = ShooterCharacter->GetCharacterMovement()->IsFalling();
-
-		// Is the character Accelerating
-		if (ShooterCharacter->GetCharacterMovement()->GetCurrentAcceleration().Size() > 0.f)
-		{
-			bIsAccelerating = true;
-		}
-		else
-		{
-			bIsAccelerating = false;
-		}
-
-		FRotator AimRotation = ShooterCharacter->GetBaseAimRotation();
-		FRotator MovementRotation = UKismetMathLibrary::MakeRotFromX(ShooterCharacter->GetVelocity());
-		MovementOffsetYaw = UKismetMathLibrary::NormalizedDeltaRotator(MovementRotation, AimRotation).Yaw;
-
-		if (ShooterCharacter->GetVelocity().Size() > 0.f)
-		{
-			LastMovementOffsetYaw = MovementOffsetYaw;
-		}
-
-		bIsWalking = ShooterCharacter->GetIsWalking();
-		bIsAiming = ShooterCharacter->GetIsAiming();
-		if(bIsAiming)
-		{
-			WalkingBlendWeight = 0.f;
-		}
-		else
-		{
-			WalkingBlendWeight = .7f;
-		}
+		const UCharacterMovementComponent* Movement = ShooterCharacter->GetCharacterMovement();
+		OutSnapshot.Velocity = ShooterCharacter->GetVelocity();
+		OutSnapshot.Acceleration = Movement->GetCurrentAcceleration();
+		OutSnapshot.AimRotation = ShooterCharacter->GetBaseAimRotation();
+		OutSnapshot.bIsFalling = Movement->IsFalling();
+		OutSnapshot.bIsWalking = ShooterCharacter->GetIsWalking();
+		OutSnapshot.bIsAiming = ShooterCharacter->GetIsAiming();
 	}
 }
 
-void UShooterAnimInstance::NativeInitializeAnimation()
+void UShooterAnimInstance::UpdateFromSnapshot(const FShooterAnimSnapshot& Snapshot)
 {
-	ShooterCharacter = Cast<AShooterCharacter>(TryGetPawnOwner());
+	if (!Snapshot.bHasCharacter)
+	{
+		return;
+	}
+
+	// Get the lateral speed of character from velocity
+	Speed = Snapshot.Velocity.Size2D();
+
+	// Is the character in the air
+	bIsInAir = Snapshot.bIsFalling;
+
+	// Is the character Accelerating
+	bIsAccelerating = Snapshot.Acceleration.SizeSquared() > 0.f;
+
+	// Same as MakeRotFromX followed by NormalizedDeltaRotator, without the Kismet calls
+	const FRotator MovementRotation = FRotationMatrix::MakeFromX(Snapshot.Velocity).Rotator();
+	MovementOffsetYaw = (MovementRotation - Snapshot.AimRotation).GetNormalized().Yaw;
+
+	if (Snapshot.Velocity.SizeSquared() > 0.f)
+	{
+		LastMovementOffsetYaw = MovementOffsetYaw;
+	}
+
+	bIsWalking = Snapshot.bIsWalking;
+	bIsAiming = Snapshot.bIsAiming;
+	if(bIsAiming)
+	{
+		WalkingBlendWeight = 0.f;
+	}
+	else
+	{
+		WalkingBlendWeight = .7f;
+	}
 }
@@ -4,23 +4,83 @@
 
 #include "CoreMinimal.h"
 #include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
 #include "ShooterAnimInstance.generated.h"
 
+class UShooterAnimInstance;
+
+/** Character state the animation properties are computed from, gathered once per frame on the game thread */
+struct FShooterAnimSnapshot
+{
+	FVector Velocity{FVector::ZeroVector};
+	FVector Acceleration{FVector::ZeroVector};
+	FRotator AimRotation{FRotator::ZeroRotator};
+	bool bIsFalling{false};
+	bool bIsWalking{false};
+	bool bIsAiming{false};
+	bool bHasCharacter{false};
+};
+
 /**
- * 
+ * Takes the snapshot in PreUpdate on the game thread, then computes the anim instance's properties in
+ * Update, which runs on a worker thread alongside the anim graph when multi-threaded animation update
+ * is enabled.
+ */
+USTRUCT()
+struct SHOOTERTEMPLATE_API FShooterAnimInstanceProxy : public FAnimInstanceProxy
+{
+	GENERATED_BODY()
+
+	FShooterAnimInstanceProxy() = default;
+
+	explicit FShooterAnimInstanceProxy(UAnimInstance* InAnimInstance)
+		: FAnimInstanceProxy(InAnimInstance)
+	{
+	}
+
+protected:
+	virtual void Initialize(UAnimInstance* InAnimInstance) override;
+	virtual void PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds) override;
+	virtual void Update(float DeltaSeconds) override;
+
+private:
+	UShooterAnimInstance* ShooterAnimInstance{nullptr};
+
+	FShooterAnimSnapshot Snapshot;
+};
+
+/**
+ *
  */
 UCLASS()
 class SHOOTERTEMPLATE_API UShooterAnimInstance : public UAnimInstance
 {
 	GENERATED_BODY()
+
+	friend struct FShooterAnimInstanceProxy;
 public:
 	UShooterAnimInstance();
-	
-	UFUNCTION(BlueprintCallable)
+
+	/** Properties are updated natively by the proxy now. Kept so existing graphs still compile */
+	UFUNCTION(BlueprintCallable, meta = (DeprecatedFunction, DeprecationMessage = "Updated natively on a worker thread, remove the call from the event graph"))
 	void UpdateAnimationProperties(float DeltaTime);
 
 	virtual void NativeInitializeAnimation() override;
+
+protected:
+	virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override { return &Proxy; }
+	virtual void DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy) override {}
+
 private:
+	/** Compute the properties from a snapshot. Safe on any thread */
+	void UpdateFromSnapshot(const FShooterAnimSnapshot& Snapshot);
+
+	/** Fill a snapshot from the owning character. Game thread only */
+	void GatherSnapshot(FShooterAnimSnapshot& OutSnapshot);
+
+	UPROPERTY(Transient)
+	FShooterAnimInstanceProxy Proxy;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
 	class AShooterCharacter* ShooterCharacter;
 
@@ -39,11 +99,11 @@ private:
 	/** Checks if the character is walking */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
 	bool bIsWalking;
-	
+
 	/** Checks if the character is Aiming*/
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
 	bool bIsAiming;
-	
+
 	/** Offset Yaw used for strafing */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
 	float MovementOffsetYaw;
@@ -4,17 +4,34 @@
 #include "ShooterCharacter.h"
 
 #include "DrawDebugHelpers.h"
+#include "FXPoolSubsystem.h"
+#include "HitboxSubsystem.h"
+#include "LagCompensationSubsystem.h"
+#include "PawnPoolSubsystem.h"
+#include "PelletPattern.h"
+#include "ShooterTemplate.h"
 #include "ShooterTemplateGameModeBase.h"
+#include "ShotTraceSubsystem.h"
 #include "Weapon.h"
+#include "WeaponInventoryComponent.h"
+#include "Animation/AnimMontage.h"
 #include "Camera/CameraComponent.h"
+#include "Camera/PlayerCameraManager.h"
 #include "Components/CapsuleComponent.h"
-#include "Engine/SkeletalMeshSocket.h"
+#include "Engine/LocalPlayer.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/GameStateBase.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Kismet/GameplayStatics.h"
+#include "Particles/ParticleSystem.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "Sound/SoundCue.h"
 
+/** Names the weapon built into the mesh uses. Weapons take theirs from their definitions */
+static const FName BarrelSocketName(TEXT("BarrelSocket"));
+static const FName BeamTargetParameter(TEXT("Target"));
+static const FName FireMontageSection(TEXT("StartFire"));
+
 // Sets default values
 AShooterCharacter::AShooterCharacter() :
 	BaseTurnRate(65.f),
@@ -28,8 +45,9 @@ AShooterCharacter::AShooterCharacter() :
 
 
 {
-	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// Only ticks while zooming or firing, see UpdateTickEnabled
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	// Creates camera boom (pulls in towards character if there is a collision)
 	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
@@ -43,6 +61,9 @@ AShooterCharacter::AShooterCharacter() :
 	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName); // attach camera to booms end
 	FollowCamera->bUsePawnControlRotation = false; // camera does not rotate relative to boom
 
+	HealthComponent = CreateDefaultSubobject<UHealthComponent>(TEXT("HealthComponent"));
+	Inventory = CreateDefaultSubobject<UWeaponInventoryComponent>(TEXT("Inventory"));
+
 	// Dont rotate when the controller rotates, Let controller only affect the camera
 	bUseControllerRotationYaw = true;
 	bUseControllerRotationRoll = false;
@@ -74,18 +95,106 @@ void AShooterCharacter::BeginPlay()
 		PlayerController->PlayerCameraManager->ViewPitchMax = 60.0;
 	}
 
-	Health = MaxHealth;
-	// Weapon = GetWorld()->SpawnActor<AWeapon>(WeaponClass);
-	// GetMesh()->HideBoneByName(TEXT("weapon_r"), EPhysBodyOp::PBO_None);
-	// Weapon->AttachToComponent(GetMesh(), FAttachmentTransformRules::KeepRelativeTransform,TEXT("WeaponSocket"));
-	// Weapon->SetOwner(this);
+	HealthComponent->OnDeath.AddUObject(this, &AShooterCharacter::OnHealthDepleted);
+	SpawnTransform = GetActorTransform();
+	BarrelSocket.Resolve(GetMesh(), BarrelSocketName);
+
+	// The inventory equipped its first weapon during Super::BeginPlay
+	Inventory->OnEquippedWeaponChanged.AddUObject(this, &AShooterCharacter::OnWeaponEquipped);
+	OnWeaponEquipped(Inventory->GetEquippedWeapon());
+
+	CombatAssets.Load(CombatAssetsId, FSimpleDelegate::CreateUObject(this, &AShooterCharacter::OnCombatAssetsLoaded));
+
+	if (UHitboxSubsystem* Hitboxes = GetWorld()->GetSubsystem<UHitboxSubsystem>())
+	{
+		Hitboxes->RegisterCharacter(this);
+	}
+
+	// Record hitbox history for lag compensated hits
+	if (HasAuthority())
+	{
+		if (ULagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<ULagCompensationSubsystem>())
+		{
+			LagCompensation->RegisterCharacter(this);
+		}
+	}
+}
+
+void AShooterCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	CombatAssets.Release();
+	if (UPawnPoolSubsystem* PawnPool = GetWorld()->GetSubsystem<UPawnPoolSubsystem>())
+	{
+		PawnPool->ForgetCharacter(this);
+	}
+	if (ULagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<ULagCompensationSubsystem>())
+	{
+		LagCompensation->UnregisterCharacter(this);
+	}
+	if (UHitboxSubsystem* Hitboxes = GetWorld()->GetSubsystem<UHitboxSubsystem>())
+	{
+		Hitboxes->UnregisterCharacter(this);
+	}
+	if (AShooterTemplateGameModeBase* GameMode = GetWorld()->GetAuthGameMode<AShooterTemplateGameModeBase>())
+	{
+		GameMode->PawnLeftMatch(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void AShooterCharacter::OnCombatAssetsLoaded()
+{
+	// Build the FX rings now rather than on the first shot
+	const UShooterCombatAssets* Assets = CombatAssets.Get();
+	UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+	if (Assets && FXPool)
+	{
+		FXPool->PrewarmPool(Assets->MuzzleFlash.Get());
+		FXPool->PrewarmPool(Assets->ImpactParticles.Get());
+		FXPool->PrewarmPool(Assets->BeamParticles.Get());
+	}
+}
+
+void AShooterCharacter::OnWeaponEquipped(AWeapon* EquippedWeapon)
+{
+	const UWeaponDefinition* Definition = EquippedWeapon ? EquippedWeapon->GetDefinition() : nullptr;
+	if (Definition)
+	{
+		FireScheduler.Configure(Definition->FireMode, Definition->RoundsPerMinute, Definition->BurstCount);
+	}
+	else
+	{
+		FireScheduler.Configure(FireMode, RoundsPerMinute, BurstCount);
+	}
+	FireScheduler.Reset();
+}
+
+void AShooterCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+	RoundController = NewController;
+
+	// Joins the match registry once its team is known from the controller
+	if (AShooterTemplateGameModeBase* GameMode = GetWorld()->GetAuthGameMode<AShooterTemplateGameModeBase>())
+	{
+		GameMode->PawnEnteredMatch(this);
+	}
 }
 
 // Called every frame
 void AShooterCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
-	ZoomInterpToFOV(DeltaTime);
+	if (bInterpolatingFOV)
+	{
+		ZoomInterpToFOV(DeltaTime);
+	}
+
+	if (FireScheduler.IsFiring())
+	{
+		FireScheduledShots();
+	}
+	UpdateTickEnabled();
 }
 
 /**==============================================================================
@@ -117,7 +226,10 @@ void AShooterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCo
 	 */
 	PlayerInputComponent->BindAction(TEXT("CameraSwitchSides"), EInputEvent::IE_Pressed, this,
 	                                 &AShooterCharacter::ToggleCameraSide);
-	PlayerInputComponent->BindAction(TEXT("FireButton"), EInputEvent::IE_Pressed, this, &AShooterCharacter::FireWeapon);
+	PlayerInputComponent->BindAction(TEXT("FireButton"), EInputEvent::IE_Pressed, this,
+	                                 &AShooterCharacter::FireButtonPressed);
+	PlayerInputComponent->BindAction(TEXT("FireButton"), EInputEvent::IE_Released, this,
+	                                 &AShooterCharacter::FireButtonReleased);
 	PlayerInputComponent->BindAction(TEXT("Run"), EInputEvent::IE_Pressed, this,
 	                                 &AShooterCharacter::CharacterSprintPressed);
 	PlayerInputComponent->BindAction(TEXT("Run"), EInputEvent::IE_Released, this,
@@ -126,6 +238,8 @@ void AShooterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCo
 	                                 &AShooterCharacter::AimingButtonPressed);
 	PlayerInputComponent->BindAction(TEXT("AimButton"), EInputEvent::IE_Released, this,
 	                                 &AShooterCharacter::AimingButtonReleased);
+	PlayerInputComponent->BindAction(TEXT("NextWeapon"), EInputEvent::IE_Pressed, Inventory,
+	                                 &UWeaponInventoryComponent::EquipNextWeapon);
 
 
 	/** Character Jump functionality can be added by uncommenting the following lines of code
@@ -140,69 +254,216 @@ void AShooterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCo
 
 #pragma region Character Combat Functionality
 
-float AShooterCharacter::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator,
-                                    AActor* DamageCauser)
+void AShooterCharacter::OnHealthDepleted(UHealthComponent* DeadHealth, AController* Killer, AActor* DamageCauser)
 {
-	float DamageToApply = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
-	DamageToApply = FMath::Min(Health, DamageToApply);
-	Health -= DamageToApply;
-	UE_LOG(LogTemp, Warning, TEXT("Health: %f"), Health);
+	AShooterTemplateGameModeBase* GameMode = GetWorld()->GetAuthGameMode<AShooterTemplateGameModeBase>();
+	if (GameMode != nullptr)
+	{
+		GameMode->PawnKilled(this);
+	}
+
+	// AI keep their controller, so both are reused when the pool hands the character out again
+	UPawnPoolSubsystem* PawnPool = GetWorld()->GetSubsystem<UPawnPoolSubsystem>();
+	if (PawnPool && !IsPlayerControlled())
+	{
+		PawnPool->ReleaseCharacter(this, true);
+	}
+	else
+	{
+		DetachFromControllerPendingDestroy();
+	}
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
+void AShooterCharacter::ResetRound()
+{
+	ReviveAt(SpawnTransform);
 
-	if (IsDead())
+	// Dead players were detached from their controller. AI controllers destroy themselves then, unless pooled
+	if (Controller == nullptr)
 	{
-		AShooterTemplateGameModeBase* GameMode = GetWorld()->GetAuthGameMode<AShooterTemplateGameModeBase>();
-		if (GameMode != nullptr)
+		AController* PreviousController = RoundController.Get();
+		if (PreviousController && PreviousController->GetPawn() == nullptr)
 		{
-			GameMode->PawnKilled(this);
+			PreviousController->Possess(this);
 		}
-		DetachFromControllerPendingDestroy();
-		GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		else
+		{
+			SpawnDefaultController();
+		}
+	}
+}
+
+void AShooterCharacter::ReviveAt(const FTransform& Transform)
+{
+	SpawnTransform = Transform;
+	HealthComponent->Revive();
+	TeleportTo(SpawnTransform.GetLocation(), SpawnTransform.Rotator(), false, true);
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+
+	// Old hitbox samples would rewind shots to where the character was last round
+	if (ULagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<ULagCompensationSubsystem>())
+	{
+		LagCompensation->UnregisterCharacter(this);
+		LagCompensation->RegisterCharacter(this);
 	}
 
-	return DamageToApply;
+	FireScheduler.Reset();
+	ShotLedger.Reset();
+	bAiming = false;
+	CameraCurrentFOV = CameraDefaultFOV;
+	GetFollowCamera()->SetFieldOfView(CameraCurrentFOV);
+	bInterpolatingFOV = false;
+	UpdateTickEnabled();
 }
 
-void AShooterCharacter::FireWeapon()
+void AShooterCharacter::SetDormant(bool bDormant)
 {
-	if (!bIsWalking) // character can only fire if he is walking
+	SetActorHiddenInGame(bDormant);
+	SetActorEnableCollision(!bDormant);
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetComponentTickEnabled(!bDormant);
+	GetMesh()->SetComponentTickEnabled(!bDormant);
+	Inventory->SetDormant(bDormant);
+	if (!bDormant)
 	{
+		// ReviveAt registers with lag compensation again and restarts the tick if needed
+		CombatAssets.Load(CombatAssetsId, FSimpleDelegate::CreateUObject(this, &AShooterCharacter::OnCombatAssetsLoaded));
 		return;
 	}
 
-	if (FireSound)
+	CombatAssets.Release();
+
+	FireScheduler.Reset();
+	ShotLedger.Reset();
+	bInterpolatingFOV = false;
+	SetActorTickEnabled(false);
+	if (ULagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<ULagCompensationSubsystem>())
 	{
-		UGameplayStatics::PlaySound2D(this, FireSound);
+		LagCompensation->UnregisterCharacter(this);
 	}
-	FVector BeamEndPoint;
-	const USkeletalMeshSocket* BarrelSocket = GetMesh()->GetSocketByName("BarrelSocket");
-	if (BarrelSocket)
+}
+
+void AShooterCharacter::FireButtonPressed()
+{
+	FireScheduler.PressTrigger(GetWorld()->GetTimeSeconds());
+
+	// The first shot goes out this frame, not on the next tick
+	FireScheduledShots();
+	UpdateTickEnabled();
+}
+
+void AShooterCharacter::FireButtonReleased()
+{
+	FireScheduler.ReleaseTrigger(GetWorld()->GetTimeSeconds());
+}
+
+void AShooterCharacter::PullTrigger()
+{
+	FireButtonPressed();
+}
+
+void AShooterCharacter::ReleaseTrigger()
+{
+	FireButtonReleased();
+}
+
+void AShooterCharacter::FireScheduledShots()
+{
+	ScheduledShotTimes.Reset();
+	if (FireScheduler.Advance(GetWorld()->GetTimeSeconds(), ScheduledShotTimes) > 0)
 	{
-		const FTransform SocketTransform = BarrelSocket->GetSocketTransform(GetMesh());
-		if (MuzzleFlash)
+		FireShots(ScheduledShotTimes);
+	}
+}
+
+void AShooterCharacter::FireShots(TArrayView<const double> ShotTimes)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterFireWeapon);
+	if (!bIsWalking) // character can only fire if he is walking
+	{
+		return;
+	}
+
+	SHOOTER_INC_COUNTER(STAT_ShooterShots, ShotTimes.Num());
+
+	// Shots are stamped with server time, offset by how long ago in this frame they were due
+	const double Now = GetWorld()->GetTimeSeconds();
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	const double ServerNow = GameState ? GameState->GetServerWorldTimeSeconds() : Now;
+
+	// The barrel and aim are sampled once for the whole batch
+	AWeapon* EquippedWeapon = Inventory->GetEquippedWeapon();
+	const UWeaponDefinition* Definition = EquippedWeapon ? EquippedWeapon->GetDefinition() : nullptr;
+	const bool bHasBarrel = BarrelSocket.IsValid();
+	const FTransform SocketTransform = bHasBarrel ? BarrelSocket.GetTransform(GetMesh()) : FTransform::Identity;
+	UShotTraceSubsystem* ShotTrace = GetWorld()->GetSubsystem<UShotTraceSubsystem>();
+	UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+	FVector AimStart;
+	FVector AimDirection;
+	const bool bHasAim = GetCrosshairRay(AimStart, AimDirection);
+
+	// Null until the combat bundle is resident, and then the shots go out without sounds or FX
+	const UShooterCombatAssets* Assets = EquippedWeapon ? EquippedWeapon->GetCombatAssets() : CombatAssets.Get();
+	USoundCue* FireSound = Assets ? Assets->FireSound.Get() : nullptr;
+	UParticleSystem* MuzzleFlash = Assets ? Assets->MuzzleFlash.Get() : nullptr;
+	UAnimMontage* HipFireMontage = Assets ? Assets->HipFireMontage.Get() : nullptr;
+
+	// Remote clients announce each shot, so the server knows which hit claims to expect and fires their rounds
+	const bool bAnnounceShots = IsLocallyControlled() && !HasAuthority();
+
+	for (const double ShotTime : ShotTimes)
+	{
+		const float FireTime = ServerNow - (Now - ShotTime);
+
+		// Weapons play their own flash and sound, and trace from their muzzle
+		if (EquippedWeapon)
 		{
-			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), MuzzleFlash, SocketTransform);
+			if (bHasAim)
+			{
+				const uint32 ShotIndex = NextShotIndex++;
+				if (bAnnounceShots)
+				{
+					ServerFireShot(AimStart, AimDirection, FireTime, ShotIndex);
+				}
+				EquippedWeapon->Fire(AimStart, AimDirection, FireTime, EquippedWeapon->GetSpreadSeed(ShotIndex),
+				                     FOnShotResolved::CreateUObject(this, &AShooterCharacter::OnShotResolved));
+			}
+			continue;
 		}
 
-		FVector BeamEnd;
-		bool bBeamEnd = GetBeamEndLocation(SocketTransform.GetLocation(), BeamEnd);
-
-		if (bBeamEnd)
+		if (FireSound)
 		{
-			// Spawn impact particles after updating beam end point
-			if (ImpactParticles)
+			UGameplayStatics::PlaySound2D(this, FireSound);
+		}
+		if (bHasBarrel)
+		{
+			if (MuzzleFlash && FXPool)
 			{
-				UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ImpactParticles, BeamEnd);
+				FXPool->SpawnAtLocation(MuzzleFlash, SocketTransform);
 			}
 
-			// Spawn bullet smoke beam particles
-			if (BeamParticles)
+			// Impact and beam FX are spawned once the shot has been traced
+			if (ShotTrace && bHasAim)
 			{
-				UParticleSystemComponent* Beam = UGameplayStatics::SpawnEmitterAtLocation(
-					GetWorld(), BeamParticles, SocketTransform);
-				if (Beam)
+				const uint32 ShotIndex = NextShotIndex++;
+				if (bAnnounceShots)
 				{
-					Beam->SetVectorParameter(FName("Target"), BeamEnd);
+					ServerFireShot(AimStart, AimDirection, FireTime, ShotIndex);
 				}
+
+				FShotRequest Shot;
+				Shot.Shooter = this;
+				Shot.Instigator = GetController();
+				Shot.AimStart = AimStart;
+				Shot.AimDirection = AimDirection;
+				Shot.Damage = ShotDamage;
+				Shot.FireTime = FireTime;
+				Shot.MuzzleTransform = SocketTransform;
+				Shot.bTraceFromMuzzle = true;
+				Shot.OnResolved.BindUObject(this, &AShooterCharacter::OnShotResolved);
+				ShotTrace->QueueShot(MoveTemp(Shot));
 			}
 		}
 	}
@@ -211,72 +472,228 @@ void AShooterCharacter::FireWeapon()
 	if (AnimInstance && HipFireMontage)
 	{
 		AnimInstance->Montage_Play(HipFireMontage);
-		AnimInstance->Montage_JumpToSection(FName("StartFire"));
+		AnimInstance->Montage_JumpToSection(Definition ? Definition->FireMontageSection : FireMontageSection);
 	}
-	//Weapon->PullTrigger();
 }
 
-bool AShooterCharacter::GetBeamEndLocation(const FVector& MuzzleSocketLocation, FVector& OutBeamLocation)
+void AShooterCharacter::OnShotResolved(const FShotRequest& Request, const FShotResult& Result)
 {
-	// Get current viewport size
-	FVector2D ViewportSize;
-	if (GEngine && GEngine->GameViewport)
+	// Remote clients don't deal damage themselves, they ask the server to confirm each character the shot hit
+	if (IsLocallyControlled() && !HasAuthority())
 	{
-		GEngine->GameViewport->GetViewportSize(ViewportSize);
+		TArray<AShooterCharacter*, TInlineAllocator<8>> HitCharacters;
+		for (const FShotRayResult& Ray : Result.GetRays())
+		{
+			AShooterCharacter* HitCharacter = Cast<AShooterCharacter>(Ray.Hit.GetActor());
+			if (Ray.bBlockingHit && HitCharacter != nullptr)
+			{
+				HitCharacters.AddUnique(HitCharacter);
+			}
+		}
+		for (AShooterCharacter* HitCharacter : HitCharacters)
+		{
+			ServerConfirmHit(HitCharacter, Request.FireTime);
+		}
 	}
 
-	// Get screen space location of crosshairs
-	FVector2D CrosshairLocation(ViewportSize.X / 2.f, ViewportSize.Y / 2.f);
-	CrosshairLocation.Y -= 50.f;
-	FVector CrosshairWorldPos;
-	FVector CrosshairWorldDir;
+	// The FX of whichever fired the shot, the equipped weapon or the one built into the mesh
+	const AWeapon* FiringWeapon = Cast<AWeapon>(Request.DamageCauser.Get());
+	const UWeaponDefinition* Definition = FiringWeapon ? FiringWeapon->GetDefinition() : nullptr;
+	UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+	const UShooterCombatAssets* Assets = FiringWeapon ? FiringWeapon->GetCombatAssets() : CombatAssets.Get();
+	if (FXPool == nullptr || Assets == nullptr)
+	{
+		return;
+	}
+	UParticleSystem* ImpactParticles = Assets->ImpactParticles.Get();
+	UParticleSystem* BeamParticles = Assets->BeamParticles.Get();
+	const FName BeamTarget = Definition ? Definition->BeamTargetParameter : BeamTargetParameter;
 
-	// Get World pos and dir of crosshairs
-	// TODO: This references a single player. possible change if multiplayer
-	bool bScreenToWorld = UGameplayStatics::DeprojectScreenToWorld(UGameplayStatics::GetPlayerController(this, 0),
-	                                                               CrosshairLocation,
-	                                                               CrosshairWorldPos,
-	                                                               CrosshairWorldDir);
+	for (const FShotRayResult& Ray : Result.GetRays())
+	{
+		// Spawn impact particles at the beam end point
+		if (ImpactParticles)
+		{
+			FXPool->SpawnAtLocation(ImpactParticles, Ray.BeamEnd);
+		}
 
-	// Was deprojection successful
-	if (bScreenToWorld)
+		// Spawn bullet smoke beam particles
+		if (BeamParticles)
+		{
+			UParticleSystemComponent* Beam = FXPool->SpawnAtLocation(BeamParticles, Request.MuzzleTransform);
+			if (Beam)
+			{
+				Beam->SetVectorParameter(BeamTarget, Ray.BeamEnd);
+			}
+		}
+	}
+}
+
+bool AShooterCharacter::ServerFireShot_Validate(FVector_NetQuantize AimStart, FVector_NetQuantizeNormal AimDirection,
+                                               float FireTime, uint32 ShotIndex)
+{
+	return FMath::IsFinite(FireTime);
+}
+
+void AShooterCharacter::ServerFireShot_Implementation(FVector_NetQuantize AimStart,
+                                                     FVector_NetQuantizeNormal AimDirection, float FireTime,
+                                                     uint32 ShotIndex)
+{
+	// Checked before anything else, so a shot that isn't recorded still moves the count on like the client's
+	if (!ShotLedger.TakeShotIndex(ShotIndex))
 	{
-		FHitResult ScreenTraceHit;
-		const FVector Start{CrosshairWorldPos};
-		const FVector End{CrosshairWorldPos + CrosshairWorldDir * 50'000.f};
+		return;
+	}
 
-		// Set OutBeamLocation to line trace end point
-		OutBeamLocation = End;
-		// Trace outward from crosshairs location
-		GetWorld()->LineTraceSingleByChannel(ScreenTraceHit, Start, End, ECollisionChannel::ECC_Visibility);
+	const ULagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<ULagCompensationSubsystem>();
+	if (IsDead() || LagCompensation == nullptr || !LagCompensation->IsRecentFireTime(FireTime))
+	{
+		return;
+	}
 
-		// Was their a trace hit?
-		if (ScreenTraceHit.bBlockingHit)
+	// Projectile shots can't be claimed as hitscan hits, their rounds deal their own damage. The scheduler is
+	// configured for the weapon the server has equipped, so its interval is the rate of fire
+	AWeapon* EquippedWeapon = Inventory->GetEquippedWeapon();
+	const UWeaponDefinition* Definition = EquippedWeapon ? EquippedWeapon->GetDefinition() : nullptr;
+	const bool bFiresProjectiles = Definition && Definition->bFireProjectiles;
+	const double MinInterval = FireScheduler.GetShotInterval() * (1.f - FireIntervalTolerance);
+	if (!ShotLedger.RecordShot(ShotIndex, FireTime, MinInterval, AimStart, AimDirection, !bFiresProjectiles))
+	{
+		return;
+	}
+
+	// Rounds on the client are only for show, so the server puts the same rounds in flight to deal the damage
+	if (bFiresProjectiles)
+	{
+		EquippedWeapon->Fire(AimStart, AimDirection, FireTime, EquippedWeapon->GetSpreadSeed(ShotIndex),
+		                     FOnShotResolved());
+	}
+}
+
+bool AShooterCharacter::ServerConfirmHit_Validate(AShooterCharacter* Target, float FireTime)
+{
+	return FMath::IsFinite(FireTime);
+}
+
+void AShooterCharacter::ServerConfirmHit_Implementation(AShooterCharacter* Target, float FireTime)
+{
+	if (IsDead() || Target == nullptr || Target == this)
+	{
+		return;
+	}
+
+	// Projectile weapons' rounds are flown and damaged with on the server, so there is no hit to claim
+	AWeapon* EquippedWeapon = Inventory->GetEquippedWeapon();
+	const UWeaponDefinition* Definition = EquippedWeapon ? EquippedWeapon->GetDefinition() : nullptr;
+	if (Definition && Definition->bFireProjectiles)
+	{
+		return;
+	}
+
+	// Only a hitscan shot the server recorded, once per target
+	const FLedgerShot* Shot = ShotLedger.ClaimHit(FireTime, Target);
+	const ULagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<ULagCompensationSubsystem>();
+	if (Shot == nullptr || LagCompensation == nullptr)
+	{
+		return;
+	}
+
+	// Replay the shot's rays the way the shot trace does, from the recorded aim and the weapon the server has
+	// equipped for this character
+	const int32 NumPellets = Definition ? FMath::Max(Definition->PelletsPerShot, 1) : 1;
+	FPelletDirections Directions;
+	if (NumPellets > 1)
+	{
+		FPelletPattern::Generate(EquippedWeapon->GetSpreadSeed(Shot->ShotIndex), NumPellets, Definition->PelletSpread,
+		                         Shot->AimDirection, Directions);
+	}
+	else
+	{
+		Directions.Add(Shot->AimDirection);
+	}
+
+	// Only pellets that hit the rewound target count. Regions come from the target's current hitboxes, with
+	// each ray moved by how far the target has since moved
+	const UHitboxSubsystem* Hitboxes = GetWorld()->GetSubsystem<UHitboxSubsystem>();
+	FHitboxSample Rewound;
+	const bool bHasRewound = Hitboxes && LagCompensation->RewindCharacter(Target, FireTime, Rewound);
+	const FVector Offset = bHasRewound
+		                       ? Target->GetCapsuleComponent()->GetComponentLocation() - Rewound.Location
+		                       : FVector::ZeroVector;
+	const float PelletDamage = Definition ? Definition->Damage : ShotDamage;
+	float Damage = 0.f;
+	int32 PelletsHit = 0;
+	FHitResult Hit;
+	for (const FVector& Direction : Directions)
+	{
+		FVector HitLocation;
+		if (!LagCompensation->ValidateHit(this, Target, Shot->AimStart, Direction, FireTime, HitLocation))
 		{
-			// Beam end point now trace hit location
-			OutBeamLocation = ScreenTraceHit.Location;
+			continue;
 		}
 
-		// Perform second trace from gun barrel
-		FHitResult WeaponTraceHit;
-		const FVector WeaponTraceStart{MuzzleSocketLocation};
-		const FVector WeaponTraceEnd{OutBeamLocation};
+		float Multiplier = 1.f;
+		FHitboxHit HitboxHit;
+		if (bHasRewound && Hitboxes->RaycastCharacter(Target, Shot->AimStart + Offset,
+		                                              HitLocation + Offset + Direction * 100.f, HitboxHit))
+		{
+			Multiplier = Hitboxes->GetDamageMultiplier(HitboxHit.Region);
+		}
 
-		GetWorld()->LineTraceSingleByChannel(WeaponTraceHit, WeaponTraceStart, WeaponTraceEnd,
-		                                     ECollisionChannel::ECC_Visibility);
-		if (WeaponTraceHit.bBlockingHit) // object between barrel and end point
+		// The damage event reports the first pellet that hit
+		if (PelletsHit++ == 0)
 		{
-			OutBeamLocation = WeaponTraceHit.Location;
+			Hit = FHitResult(Target, Target->GetCapsuleComponent(), HitLocation, -Direction);
+			Hit.BoneName = HitboxHit.Bone;
 		}
+		Damage += PelletDamage * Multiplier;
+	}
+	if (PelletsHit == 0)
+	{
+		return;
+	}
+
+	AActor* DamageCauser = EquippedWeapon ? static_cast<AActor*>(EquippedWeapon) : this;
+	FPointDamageEvent DamageEvent(Damage, Hit, Shot->AimDirection, nullptr);
+	Target->TakeDamage(Damage, DamageEvent, GetController(), DamageCauser);
+}
+
+bool AShooterCharacter::GetCrosshairRay(FVector& OutStart, FVector& OutDirection) const
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterCrosshairRay);
+	const APlayerController* OwningController = Cast<APlayerController>(Controller);
+	if (OwningController == nullptr || OwningController->PlayerCameraManager == nullptr)
+	{
+		// AI have no crosshairs and aim from their eyes
+		FRotator EyeRotation;
+		GetActorEyesViewPoint(OutStart, EyeRotation);
+		OutDirection = EyeRotation.Vector();
 		return true;
 	}
-	return false;
+
+	// This player's own view, which is only part of the viewport in split screen
+	const APlayerCameraManager* CameraManager = OwningController->PlayerCameraManager;
+	const ULocalPlayer* LocalPlayer = OwningController->GetLocalPlayer();
+	int32 ViewportX = 0;
+	int32 ViewportY = 0;
+	OwningController->GetViewportSize(ViewportX, ViewportY);
+	const float ViewWidth = ViewportX * (LocalPlayer ? LocalPlayer->Size.X : 1.f);
+
+	// The crosshairs sit CrosshairOffset pixels above the view's center. A pixel offset of d from the center
+	// is a slope of 2 * d * tan(FOV / 2) / width, with the FOV horizontal, so no deprojection is needed
+	const FRotationMatrix CameraAxes(CameraManager->GetCameraRotation());
+	const float TanHalfFOV = FMath::Tan(FMath::DegreesToRadians(CameraManager->GetFOVAngle() * 0.5f));
+	const float UpSlope = ViewWidth > 0.f ? 2.f * CrosshairOffset * TanHalfFOV / ViewWidth : 0.f;
+
+	OutStart = CameraManager->GetCameraLocation();
+	OutDirection = (CameraAxes.GetScaledAxis(EAxis::X) + CameraAxes.GetScaledAxis(EAxis::Z) * UpSlope).GetSafeNormal();
+	return true;
 }
 
 
 bool AShooterCharacter::IsDead() const
 {
-	return Health <= 0;
+	return HealthComponent->IsDead();
 }
 
 #pragma endregion
@@ -331,40 +748,54 @@ void AShooterCharacter::CharacterSprintPressed()
 {
 	GetCharacterMovement()->MaxWalkSpeed = RunSpeed;
 	bIsWalking = false;
+	StartZoomTransition();
 }
 
 void AShooterCharacter::CharacterSprintReleased()
 {
 	GetCharacterMovement()->MaxWalkSpeed = WalkSpeed;
 	bIsWalking = true;
+	StartZoomTransition();
 }
 
 void AShooterCharacter::AimingButtonPressed()
 {
 	bAiming = true;
+	StartZoomTransition();
 }
 
 void AShooterCharacter::AimingButtonReleased()
 {
 	bAiming = false;
+	StartZoomTransition();
 }
 
 void AShooterCharacter::ZoomInterpToFOV(float DeltaTime)
 {
-	// Set current FOV
-	if (bAiming && bIsWalking)
-	{
-		// Interp to zoomed FOV
-		CameraCurrentFOV = FMath::FInterpTo(CameraCurrentFOV, CameraZoomedFOV, DeltaTime, ZoomInterpSpeed);
-	}
-	else
+	// Zoomed while aiming and walking, default otherwise
+	const float TargetFOV = bAiming && bIsWalking ? CameraZoomedFOV : CameraDefaultFOV;
+	CameraCurrentFOV = FMath::FInterpTo(CameraCurrentFOV, TargetFOV, DeltaTime, ZoomInterpSpeed);
+
+	// FInterpTo only approaches the target, so snap once it's close and stop interpolating
+	if (FMath::IsNearlyEqual(CameraCurrentFOV, TargetFOV, ZoomSnapTolerance))
 	{
-		// Interp to default FOV
-		CameraCurrentFOV = FMath::FInterpTo(CameraCurrentFOV, CameraDefaultFOV, DeltaTime, ZoomInterpSpeed);
+		CameraCurrentFOV = TargetFOV;
+		bInterpolatingFOV = false;
 	}
 	GetFollowCamera()->SetFieldOfView(CameraCurrentFOV);
 }
 
+void AShooterCharacter::StartZoomTransition()
+{
+	bInterpolatingFOV = true;
+	UpdateTickEnabled();
+}
+
+void AShooterCharacter::UpdateTickEnabled()
+{
+	SetActorTickEnabled(bInterpolatingFOV || FireScheduler.IsFiring());
+}
+
 void AShooterCharacter::ToggleCameraSide()
 {
 	// Changes whether or not the camera is on the left or ride side of character
@@ -3,6 +3,11 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "FireScheduler.h"
+#include "HealthComponent.h"
+#include "ShooterCombatAssets.h"
+#include "ShotLedger.h"
+#include "WeaponDefinition.h"
 #include "GameFramework/Character.h"
 #include "ShooterCharacter.generated.h"
 
@@ -19,6 +24,12 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the character is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called on the server when a controller takes over the character
+	virtual void PossessedBy(AController* NewController) override;
+
 	void MoveForward(float AxisValue);
 	void MoveRight(float AxisValue);
 
@@ -34,11 +45,48 @@ protected:
 	*/
 	void LookUpAtRate(float Rate);
 
-	/** Called when FireWeapon is pressed*/
-	void FireWeapon();
+	/** Fire button bindings, drive the fire scheduler */
+	void FireButtonPressed();
+	void FireButtonReleased();
+
+	/** Fire every shot the scheduler has due this frame */
+	void FireScheduledShots();
+
+	/** Fire a batch of shots, each at its own time within this frame */
+	void FireShots(TArrayView<const double> ShotTimes);
+
+	/** World space ray through the crosshairs, from the owning player's own view. AI aim from their eyes */
+	bool GetCrosshairRay(FVector& OutStart, FVector& OutDirection) const;
+
+	/** Builds the FX rings for the combat assets once they are resident */
+	void OnCombatAssetsLoaded();
+
+	/** Tells the game mode and hands the corpse to the pawn pool, from the damage queue's death phase */
+	void OnHealthDepleted(UHealthComponent* DeadHealth, AController* Killer, AActor* DamageCauser);
+
+	/** Spawns impact and beam FX once a queued shot has been traced */
+	void OnShotResolved(const struct FShotRequest& Request, const struct FShotResult& Result);
+
+	/** Fire with the equipped weapon's definition, or with the character's own settings without one */
+	void OnWeaponEquipped(class AWeapon* EquippedWeapon);
+
+	/**
+	 * Client announces a shot before claiming hits with it. Recorded in the shot ledger if it respects the
+	 * equipped weapon's rate of fire. Projectile weapons' rounds are then put in flight on the server too
+	 * @param ShotIndex the client's count of shots before this one. It must follow the last announced shot's,
+	 * and the server derives the pellet pattern from it
+	 */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerFireShot(FVector_NetQuantize AimStart, FVector_NetQuantizeNormal AimDirection, float FireTime,
+	                    uint32 ShotIndex);
 
-	/** Weapon fire line tracing*/
-	bool GetBeamEndLocation(const FVector& MuzzleSocketLocation, FVector& OutBeamLocation);
+	/**
+	 * Client claims the shot it fired at FireTime hit another character. The shot must be a hitscan shot in
+	 * the ledger, not yet claimed against Target. The server replays its pellets against Target's rewound
+	 * hitboxes, and only those that hit deal damage. Projectile shots are never claimable
+	 */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerConfirmHit(AShooterCharacter* Target, float FireTime);
 
 	/** Character sprint functions*/
 	void CharacterSprintPressed();
@@ -47,7 +95,13 @@ protected:
 	/** Character aim functions */
 	void AimingButtonPressed();
 	void AimingButtonReleased();
-    void ZoomInterpToFOV(float DeltaTime);
+	void ZoomInterpToFOV(float DeltaTime);
+
+	/** Start interpolating the camera FOV toward the zoom target for the current state */
+	void StartZoomTransition();
+
+	/** Tick only while the FOV is interpolating or the fire scheduler has shots pending */
+	void UpdateTickEnabled();
 	
 	/** Camera option functions */
 	void ToggleCameraSide();
@@ -65,9 +119,9 @@ public:
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
-	// Take Damage to character
-	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent,
-	                         class AController* EventInstigator, AActor* DamageCauser) override;
+	/** Trigger presses for scripted shooters like perf bots. The shots go through the same fire path as input */
+	void PullTrigger();
+	void ReleaseTrigger();
 
 private:
 	/** Base Turn rate, in deg/sec. Other scaling may affect final turn rate */
@@ -103,17 +157,22 @@ private:
 	UPROPERTY(VisibleAnywhere)
 	APlayerController* PlayerController;
 
-	UPROPERTY(EditDefaultsOnly)
-	TSubclassOf<class AWeapon> WeaponClass;
+	/** Weapons carried. Without one equipped, the character fires the weapon built into its mesh */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	class UWeaponInventoryComponent* Inventory;
 
-	UPROPERTY(VisibleAnywhere)
-	AWeapon* Weapon;
+	/** Barrel of the weapon built into the mesh, resolved at begin play */
+	FResolvedSocket BarrelSocket;
 
-	UPROPERTY(EditDefaultsOnly)
-	float MaxHealth{100};
+	/** Takes the character's damage. Deaths are processed once per frame by the damage queue */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	UHealthComponent* HealthComponent;
 
-	UPROPERTY(VisibleAnywhere)
-	float Health;
+	/** Where the character started the round */
+	FTransform SpawnTransform;
+
+	/** Controller that last possessed the character, to hand it back after a round reset */
+	TWeakObjectPtr<AController> RoundController;
 
 	UPROPERTY(EditDefaultsOnly)
 	float WalkSpeed{160.f};
@@ -125,29 +184,47 @@ private:
 	UPROPERTY(VisibleAnywhere)
 	bool bIsWalking;
 
-	/** Randomize gunshot sound cue*/
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	class USoundCue* FireSound;
+	/** How the fire button fires, without a weapon equipped */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	EFireMode FireMode{EFireMode::SemiAuto};
 
-	/** Randomize gunshot impact sound cue*/
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	class USoundCue* ImpactSound;
+	/** Rate of fire for burst and full auto, and the cooldown between semi auto shots */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float RoundsPerMinute{600.f};
 
-	/** Flash spawned at BarrelSocket */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	class UParticleSystem* MuzzleFlash;
+	/** Shots per trigger pull in burst mode */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	int32 BurstCount{3};
 
-	/** Montage for firing weapon */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	class UAnimMontage* HipFireMontage;
+	FFireScheduler FireScheduler;
 
-	/** Particles spawned upon bullet impact */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	UParticleSystem* ImpactParticles;
+	/** Scratch for the shot times due each frame */
+	TArray<double> ScheduledShotTimes;
 
-	/** Smoke trail for bullets */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	UParticleSystem* BeamParticles;
+	/** Server only. Shots the owning client announced, which its hit claims must match */
+	FShotLedger ShotLedger;
+
+	/** Shots this character has fired through FireShots. Numbers the announced shots and picks their pellets */
+	uint32 NextShotIndex{0};
+
+	/** Fraction of the shot interval a client's shot may come early by, for jitter in its server clock */
+	UPROPERTY(EditDefaultsOnly, Category = Combat)
+	float FireIntervalTolerance{0.1f};
+
+	/** Pixels the crosshairs sit above the center of the player's view */
+	UPROPERTY(EditDefaultsOnly, Category = Combat)
+	float CrosshairOffset{50.f};
+
+	/** Damage dealt by each hitscan shot, without a weapon equipped */
+	UPROPERTY(EditDefaultsOnly, Category = Combat)
+	float ShotDamage{10.f};
+
+	/** Sounds, FX and montage. Soft referenced, and loaded without blocking when the character begins play */
+	UPROPERTY(EditDefaultsOnly, Category = Combat, meta = (AllowedTypes = "ShooterCombatAssets"))
+	FPrimaryAssetId CombatAssetsId;
+
+	/** Shots skip their sounds, FX and montage until the combat bundle is resident */
+	FCombatAssetsLoader CombatAssets;
 
 	/** True when aiming */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
@@ -165,6 +242,13 @@ private:
 	/** Interp speed for zooming when aiming */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float ZoomInterpSpeed;
+
+	/** The zoom stops interpolating once the FOV is this close to its target */
+	UPROPERTY(EditAnywhere, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float ZoomSnapTolerance{0.05f};
+
+	/** True while the FOV is moving toward its target */
+	bool bInterpolatingFOV{false};
 public:
 	// Returns CameraBoom Component when called
 	FORCEINLINE USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
@@ -177,4 +261,31 @@ public:
 
 	// Returns the players aim status
 	FORCEINLINE bool GetIsAiming() const { return bAiming; }
+
+	// Returns the character's current health
+	FORCEINLINE float GetHealth() const { return HealthComponent->GetHealth(); }
+
+	// Returns the health the character spawns with
+	FORCEINLINE float GetMaxHealth() const { return HealthComponent->GetMaxHealth(); }
+
+	// Sets health directly, clamped to [0, MaxHealth]. Doesn't kill the character
+	FORCEINLINE void SetHealth(float NewHealth) { HealthComponent->SetHealth(NewHealth); }
+
+	// Returns the component that takes the character's damage
+	FORCEINLINE UHealthComponent* GetHealthComponent() const { return HealthComponent; }
+
+	// Returns the weapons the character carries
+	FORCEINLINE UWeaponInventoryComponent* GetInventory() const { return Inventory; }
+
+	// Revives the character at full health where it spawned, and gives it back to its last controller
+	void ResetRound();
+
+	// Revives the character at full health at Transform, which becomes where it spawned
+	void ReviveAt(const FTransform& Transform);
+
+	// Hides the character and stops its collision, movement, animation and tick while it waits in the pawn pool
+	void SetDormant(bool bDormant);
+
+	// Returns where the character starts the round
+	FORCEINLINE const FTransform& GetSpawnTransform() const { return SpawnTransform; }
 };
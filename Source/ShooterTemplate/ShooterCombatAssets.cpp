@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterCombatAssets.h"
+
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+
+const FPrimaryAssetType UShooterCombatAssets::PrimaryAssetType(TEXT("ShooterCombatAssets"));
+const FName UShooterCombatAssets::CombatBundle(TEXT("Combat"));
+
+FPrimaryAssetId UShooterCombatAssets::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
+
+void FCombatAssetsLoader::Load(const FPrimaryAssetId& AssetsId, FSimpleDelegate OnLoaded)
+{
+	Release();
+	if (!AssetsId.IsValid() || !UAssetManager::IsValid())
+	{
+		return;
+	}
+
+	LoadingId = AssetsId;
+	TSharedPtr<FStreamableHandle> SharedHandle =
+		UAssetManager::Get().LoadPrimaryAsset(AssetsId, {UShooterCombatAssets::CombatBundle});
+	if (SharedHandle.IsValid() && !SharedHandle->HasLoadCompleted())
+	{
+		// Every loader of a variant gets the same handle from the asset manager, so wait on one of our own
+		Handle = UAssetManager::GetStreamableManager().CreateCombinedHandle({SharedHandle}, TEXT("CombatAssets"));
+		Handle->BindCompleteDelegate(FStreamableDelegate::CreateLambda([this, OnLoaded]()
+		{
+			// Release unbinds this before the loader goes away
+			Assets = UAssetManager::Get().GetPrimaryAssetObject<UShooterCombatAssets>(LoadingId);
+			OnLoaded.ExecuteIfBound();
+		}));
+		return;
+	}
+
+	// Already resident, e.g. another character of the same variant loaded it
+	Assets = UAssetManager::Get().GetPrimaryAssetObject<UShooterCombatAssets>(AssetsId);
+	OnLoaded.ExecuteIfBound();
+}
+
+void FCombatAssetsLoader::Release()
+{
+	if (Handle.IsValid())
+	{
+		Handle->BindCompleteDelegate(FStreamableDelegate());
+		Handle.Reset();
+	}
+	Assets = nullptr;
+}
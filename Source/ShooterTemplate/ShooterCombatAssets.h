@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "ShooterCombatAssets.generated.h"
+
+class UAnimMontage;
+class UParticleSystem;
+class USoundCue;
+
+/**
+ * Sounds, FX and montages for one character or weapon variant. Everything is soft referenced in the
+ * Combat bundle, so a variant's assets only load once something using it is in play. Characters use
+ * the fire, impact and beam entries, weapons the muzzle flash and hit effect.
+ */
+UCLASS(BlueprintType)
+class SHOOTERTEMPLATE_API UShooterCombatAssets : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+public:
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	/** Bundle holding every asset below */
+	static const FName CombatBundle;
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	UPROPERTY(EditDefaultsOnly, Category = Combat, meta = (AssetBundles = "Combat"))
+	TSoftObjectPtr<USoundCue> FireSound;
+
+	UPROPERTY(EditDefaultsOnly, Category = Combat, meta = (AssetBundles = "Combat"))
+	TSoftObjectPtr<USoundCue> ImpactSound;
+
+	/** Flash spawned at the barrel */
+	UPROPERTY(EditDefaultsOnly, Category = Combat, meta = (AssetBundles = "Combat"))
+	TSoftObjectPtr<UParticleSystem> MuzzleFlash;
+
+	/** Spawned where a character's shot lands */
+	UPROPERTY(EditDefaultsOnly, Category = Combat, meta = (AssetBundles = "Combat"))
+	TSoftObjectPtr<UParticleSystem> ImpactParticles;
+
+	/** Smoke trail from the barrel to where the shot lands */
+	UPROPERTY(EditDefaultsOnly, Category = Combat, meta = (AssetBundles = "Combat"))
+	TSoftObjectPtr<UParticleSystem> BeamParticles;
+
+	/** Spawned where a weapon's shot or round lands */
+	UPROPERTY(EditDefaultsOnly, Category = Combat, meta = (AssetBundles = "Combat"))
+	TSoftObjectPtr<UParticleSystem> HitEffect;
+
+	UPROPERTY(EditDefaultsOnly, Category = Combat, meta = (AssetBundles = "Combat"))
+	TSoftObjectPtr<UAnimMontage> HipFireMontage;
+};
+
+/**
+ * Loads a combat assets bundle through the asset manager without blocking. Until the bundle is resident
+ * Get returns null, and callers skip their sounds and FX.
+ */
+struct SHOOTERTEMPLATE_API FCombatAssetsLoader
+{
+	/**
+	 * Start loading AssetsId's Combat bundle. OnLoaded runs once it is resident, right away if it already is.
+	 * Bind it to the owning object, so it is skipped if the owner is gone by then
+	 */
+	void Load(const FPrimaryAssetId& AssetsId, FSimpleDelegate OnLoaded);
+
+	/** Drop this loader's hold on the bundle */
+	void Release();
+
+	FORCEINLINE const UShooterCombatAssets* Get() const { return Assets; }
+
+private:
+	TSharedPtr<struct FStreamableHandle> Handle;
+
+	/** Kept alive by the asset manager while the bundle is loaded */
+	const UShooterCombatAssets* Assets{nullptr};
+
+	FPrimaryAssetId LoadingId;
+};
@@ -11,7 +11,7 @@ public class ShooterTemplate : ModuleRules
 		PublicDependencyModuleNames.AddRange(new string[]
 			{"Core", "CoreUObject", "Engine", "InputCore", "GameplayTasks", "UMG"});
 
-		PrivateDependencyModuleNames.AddRange(new string[] { });
+		PrivateDependencyModuleNames.AddRange(new string[] {"Json", "RenderCore"});
 
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
@@ -4,3 +4,32 @@
 #include "Modules/ModuleManager.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, ShooterTemplate, "ShooterTemplate" );
+
+DEFINE_STAT(STAT_ShooterFireWeapon);
+DEFINE_STAT(STAT_ShooterCrosshairRay);
+DEFINE_STAT(STAT_ShooterTakeDamage);
+DEFINE_STAT(STAT_ShooterPawnKilled);
+DEFINE_STAT(STAT_ShooterAnimUpdate);
+DEFINE_STAT(STAT_ShooterBTServices);
+DEFINE_STAT(STAT_ShooterShotTrace);
+DEFINE_STAT(STAT_ShooterShotResolve);
+DEFINE_STAT(STAT_ShooterProjectiles);
+DEFINE_STAT(STAT_ShooterLagCompensation);
+DEFINE_STAT(STAT_ShooterAIVisibility);
+DEFINE_STAT(STAT_ShooterAISignificance);
+DEFINE_STAT(STAT_ShooterCrowd);
+DEFINE_STAT(STAT_ShooterCreateWidget);
+DEFINE_STAT(STAT_ShooterDamageResolve);
+DEFINE_STAT(STAT_ShooterHitboxUpdate);
+DEFINE_STAT(STAT_ShooterSpatialHash);
+DEFINE_STAT(STAT_ShooterSpatialQuery);
+
+DEFINE_STAT(STAT_ShooterShots);
+DEFINE_STAT(STAT_ShooterTraces);
+DEFINE_STAT(STAT_ShooterLOSChecks);
+DEFINE_STAT(STAT_ShooterLOSGridAnswers);
+DEFINE_STAT(STAT_ShooterFXSpawns);
+DEFINE_STAT(STAT_ShooterDamageHits);
+DEFINE_STAT(STAT_ShooterDeaths);
+
+CSV_DEFINE_CATEGORY_MODULE(SHOOTERTEMPLATE_API, ShooterTemplate, true);
@@ -3,4 +3,60 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
 
+/** Gameplay profiling: stat ShooterTemplate, the ShooterTemplate CSV category and trace CPU events */
+#define SHOOTER_PROFILING !UE_BUILD_SHIPPING
+
+DECLARE_STATS_GROUP(TEXT("ShooterTemplate"), STATGROUP_ShooterTemplate, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Fire Weapon"), STAT_ShooterFireWeapon, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Crosshair Ray"), STAT_ShooterCrosshairRay, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Take Damage"), STAT_ShooterTakeDamage, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pawn Killed"), STAT_ShooterPawnKilled, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Anim Update"), STAT_ShooterAnimUpdate, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("BT Services"), STAT_ShooterBTServices, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Shot Trace"), STAT_ShooterShotTrace, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Shot Resolve"), STAT_ShooterShotResolve, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Projectiles"), STAT_ShooterProjectiles, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Lag Compensation"), STAT_ShooterLagCompensation, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AI Visibility"), STAT_ShooterAIVisibility, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AI Significance"), STAT_ShooterAISignificance, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Crowd"), STAT_ShooterCrowd, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Create Widget"), STAT_ShooterCreateWidget, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Damage Resolve"), STAT_ShooterDamageResolve, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Hitbox Update"), STAT_ShooterHitboxUpdate, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spatial Hash"), STAT_ShooterSpatialHash, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spatial Query"), STAT_ShooterSpatialQuery, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Shots"), STAT_ShooterShots, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Traces"), STAT_ShooterTraces, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("AI LOS Checks"), STAT_ShooterLOSChecks, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("AI LOS Grid Answers"), STAT_ShooterLOSGridAnswers, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("FX Spawns"), STAT_ShooterFXSpawns, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Damage Hits"), STAT_ShooterDamageHits, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Deaths"), STAT_ShooterDeaths, STATGROUP_ShooterTemplate, SHOOTERTEMPLATE_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(SHOOTERTEMPLATE_API, ShooterTemplate);
+
+#if SHOOTER_PROFILING
+
+/** Time the enclosing scope in the stat group, the CSV category and trace */
+#define SHOOTER_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	CSV_SCOPED_TIMING_STAT(ShooterTemplate, Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
+
+/** Add to a per-frame counter in the stat group and the CSV category. Safe on any thread */
+#define SHOOTER_INC_COUNTER(Stat, Amount) \
+	INC_DWORD_STAT_BY(Stat, Amount); \
+	CSV_CUSTOM_STAT(ShooterTemplate, Stat, static_cast<int32>(Amount), ECsvCustomStatOp::Accumulate)
+
+#else
+
+#define SHOOTER_SCOPE_CYCLE_COUNTER(Stat)
+#define SHOOTER_INC_COUNTER(Stat, Amount)
+
+#endif
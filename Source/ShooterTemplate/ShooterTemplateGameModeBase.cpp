@@ -3,7 +3,82 @@
 
 #include "ShooterTemplateGameModeBase.h"
 
+#include "FXPoolSubsystem.h"
+#include "PawnPoolSubsystem.h"
+#include "ProjectileSubsystem.h"
+#include "ShooterAIController.h"
+#include "ShooterCharacter.h"
+#include "ShooterTemplatePlayerController.h"
+#include "EngineUtils.h"
+#include "TimerManager.h"
+
+void AShooterTemplateGameModeBase::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UPawnPoolSubsystem* PawnPool = GetWorld()->GetSubsystem<UPawnPoolSubsystem>())
+	{
+		PawnPool->PrewarmFromConfig();
+	}
+}
+
 void AShooterTemplateGameModeBase::PawnKilled(APawn* PawnKilled)
 {
 	
 }
+
+void AShooterTemplateGameModeBase::PawnEnteredMatch(APawn* Pawn)
+{
+}
+
+void AShooterTemplateGameModeBase::PawnLeftMatch(APawn* Pawn)
+{
+}
+
+void AShooterTemplateGameModeBase::ResetRound()
+{
+	GetWorldTimerManager().ClearTimer(RoundResetTimer);
+	UWorld* World = GetWorld();
+
+	// Effects and rounds still in flight belong to the old round
+	if (UFXPoolSubsystem* FXPool = World->GetSubsystem<UFXPoolSubsystem>())
+	{
+		FXPool->DeactivateAll();
+	}
+	if (UProjectileSubsystem* Projectiles = World->GetSubsystem<UProjectileSubsystem>())
+	{
+		Projectiles->ClearProjectiles();
+	}
+
+	// Characters first, so AI that kept their controller restart from the reset location
+	UPawnPoolSubsystem* PawnPool = World->GetSubsystem<UPawnPoolSubsystem>();
+	for (TActorIterator<AShooterCharacter> It(World); It; ++It)
+	{
+		// Pooled characters only come back if they died this round. ReturnToPlay revives them where they spawned
+		if (PawnPool && PawnPool->IsReleased(*It))
+		{
+			PawnPool->ReturnToPlay(*It);
+			continue;
+		}
+		It->ResetRound();
+	}
+	for (FConstControllerIterator It = World->GetControllerIterator(); It; ++It)
+	{
+		if (AShooterAIController* AIController = Cast<AShooterAIController>(It->Get()))
+		{
+			AIController->ResetRound();
+		}
+		else if (AShooterTemplatePlayerController* PlayerController = Cast<AShooterTemplatePlayerController>(It->Get()))
+		{
+			PlayerController->ClientRoundReset();
+		}
+	}
+}
+
+void AShooterTemplateGameModeBase::ScheduleRoundReset()
+{
+	if (bSoftRoundReset)
+	{
+		GetWorldTimerManager().SetTimer(RoundResetTimer, this, &AShooterTemplateGameModeBase::ResetRound, RoundResetDelay);
+	}
+}
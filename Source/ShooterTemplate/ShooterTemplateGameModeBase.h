@@ -15,4 +15,37 @@ class SHOOTERTEMPLATE_API AShooterTemplateGameModeBase : public AGameModeBase
 	GENERATED_BODY()
 public:
 	virtual void PawnKilled(APawn* PawnKilled);
+
+	/** A pawn was possessed on the server and joins the match */
+	virtual void PawnEnteredMatch(APawn* Pawn);
+
+	/** A pawn is being removed from the world, dead or alive */
+	virtual void PawnLeftMatch(APawn* Pawn);
+
+	/**
+	 * Put every character, AI and effect back to the start of the round without reloading the level.
+	 * Dead characters are revived and possessed again by their controller, or a new AI controller.
+	 * Pooled AI that died this round are taken back out of the pawn pool
+	 */
+	UFUNCTION(BlueprintCallable, Category = Round)
+	virtual void ResetRound();
+
+	/** When false, players fall back to reloading the level with RestartLevel */
+	FORCEINLINE bool UsesSoftRoundReset() const { return bSoftRoundReset; }
+
+protected:
+	/** Creates the pawn pool's dormant characters before anyone needs them */
+	virtual void BeginPlay() override;
+
+	/** Call ResetRound after RoundResetDelay, if soft reset is in use */
+	void ScheduleRoundReset();
+
+	UPROPERTY(EditDefaultsOnly, Category = Round)
+	bool bSoftRoundReset{true};
+
+	/** Seconds between the end of a round and the soft reset */
+	UPROPERTY(EditDefaultsOnly, Category = Round)
+	float RoundResetDelay{5.f};
+
+	FTimerHandle RoundResetTimer;
 };
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterTemplateGameState.h"
+
+#include "Net/UnrealNetwork.h"
+
+void AShooterTemplateGameState::SetMatchState(const FMatchState& NewMatchState)
+{
+	MatchState = NewMatchState;
+	OnMatchStateChanged.Broadcast(MatchState);
+}
+
+void AShooterTemplateGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME(AShooterTemplateGameState, MatchState);
+}
+
+void AShooterTemplateGameState::OnRep_MatchState()
+{
+	OnMatchStateChanged.Broadcast(MatchState);
+}
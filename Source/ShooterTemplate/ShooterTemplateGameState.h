@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameStateBase.h"
+#include "ShooterTemplateGameState.generated.h"
+
+/** Side a pawn fights for */
+UENUM(BlueprintType)
+enum class EShooterTeam : uint8
+{
+	Players,
+	Bots
+};
+
+/** Alive and dead counts per team, kept up to date by the game mode as pawns enter, die and leave */
+USTRUCT(BlueprintType)
+struct FMatchState
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Match)
+	int32 PlayersAlive{0};
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Match)
+	int32 PlayersDead{0};
+
+	/** Includes crowd agents that are not promoted to actors */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Match)
+	int32 BotsAlive{0};
+
+	/** Includes crowd agents killed without being promoted */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Match)
+	int32 BotsDead{0};
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Match)
+	bool bMatchOver{false};
+
+	/** Only meaningful once bMatchOver is set */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Match)
+	bool bPlayersWon{false};
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMatchStateChanged, const FMatchState&, MatchState);
+
+/**
+ * Replicates the match state to every client, so the HUD can bind to OnMatchStateChanged instead of
+ * polling the game mode, which only exists on the server.
+ */
+UCLASS()
+class SHOOTERTEMPLATE_API AShooterTemplateGameState : public AGameStateBase
+{
+	GENERATED_BODY()
+public:
+	/** Server only. Replicates the new state and broadcasts OnMatchStateChanged */
+	void SetMatchState(const FMatchState& NewMatchState);
+
+	UFUNCTION(BlueprintPure, Category = Match)
+	const FMatchState& GetMatchState() const { return MatchState; }
+
+	/** Broadcast on the server and on clients whenever the match state changes */
+	UPROPERTY(BlueprintAssignable, Category = Match)
+	FOnMatchStateChanged OnMatchStateChanged;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+private:
+	UFUNCTION()
+	void OnRep_MatchState();
+
+	UPROPERTY(ReplicatedUsing = OnRep_MatchState)
+	FMatchState MatchState;
+};
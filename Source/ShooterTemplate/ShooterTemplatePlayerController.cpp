@@ -3,18 +3,42 @@
 
 #include "ShooterTemplatePlayerController.h"
 
-#include "Blueprint/UserWidget.h"
+#include "ShooterTemplateGameModeBase.h"
+#include "ShooterUIManager.h"
 
+static const FName LoseScreenName(TEXT("LoseScreen"));
+static const FName WinScreenName(TEXT("WinScreen"));
+
+AShooterTemplatePlayerController::AShooterTemplatePlayerController()
+{
+	UIManager = CreateDefaultSubobject<UShooterUIManager>(TEXT("UIManager"));
+}
+
+void AShooterTemplatePlayerController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	UIManager->AddScreen(LoseScreenName, LoseScreenClass);
+	UIManager->AddScreen(WinScreenName, WinScreenClass);
+	UIManager->PreloadScreens();
+}
 
 void AShooterTemplatePlayerController::GameHasEnded(AActor* EndGameFocus, bool bIsWinner)
 {
 	Super::GameHasEnded(EndGameFocus, bIsWinner);
 
-	UUserWidget* LoseScreen = CreateWidget(this, LoseScreenClass);
-	if (LoseScreen != nullptr)
+	// Already built during level start, so this only makes it visible
+	UIManager->ShowScreen(bIsWinner && !WinScreenClass.IsNull() ? WinScreenName : LoseScreenName);
+
+	// The game mode soft resets the round itself, without a level reload
+	const AShooterTemplateGameModeBase* GameMode = GetWorld()->GetAuthGameMode<AShooterTemplateGameModeBase>();
+	if (GameMode == nullptr || !GameMode->UsesSoftRoundReset())
 	{
-		LoseScreen->AddToViewport();
+		GetWorldTimerManager().SetTimer(RestartTimer,this, &APlayerController::RestartLevel,RestartDelay);
 	}
-	
-	GetWorldTimerManager().SetTimer(RestartTimer,this, &APlayerController::RestartLevel,RestartDelay);
+}
+
+void AShooterTemplatePlayerController::ClientRoundReset_Implementation()
+{
+	UIManager->HideAllScreens();
 }
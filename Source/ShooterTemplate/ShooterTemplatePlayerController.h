@@ -15,15 +15,34 @@ class SHOOTERTEMPLATE_API AShooterTemplatePlayerController : public APlayerContr
 	GENERATED_BODY()
 
 public:
+	AShooterTemplatePlayerController();
+
 	virtual void GameHasEnded(AActor* EndGameFocus, bool bIsWinner) override;
+
+	/** The round was soft reset on the server. Removes the end screen */
+	UFUNCTION(Client, Reliable)
+	void ClientRoundReset();
+
+	FORCEINLINE class UShooterUIManager* GetUIManager() const { return UIManager; }
+
+protected:
+	/** Registers the end screens with the UI manager and starts preloading them */
+	virtual void BeginPlay() override;
+
 private:
+	/** Builds the screens up front and toggles them, so nothing is constructed when the round ends */
+	UPROPERTY(VisibleAnywhere, Category = UI)
+	class UShooterUIManager* UIManager;
 
-	UPROPERTY(EditAnywhere )
-	TSubclassOf<class UUserWidget> LoseScreenClass;
+	UPROPERTY(EditAnywhere)
+	TSoftClassPtr<class UUserWidget> LoseScreenClass;
+
+	/** Shown instead of LoseScreenClass when the player's side won. Falls back to LoseScreenClass if unset */
+	UPROPERTY(EditAnywhere)
+	TSoftClassPtr<class UUserWidget> WinScreenClass;
 	
 	UPROPERTY(EditAnywhere)
 	float RestartDelay = 5;
 
 	FTimerHandle RestartTimer;
-	
 };
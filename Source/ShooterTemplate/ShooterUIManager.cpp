@@ -0,0 +1,181 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterUIManager.h"
+
+#include "ShooterTemplate.h"
+#include "Blueprint/UserWidget.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "GameFramework/PlayerController.h"
+
+static FAutoConsoleCommandWithWorld UIStatsCommand(
+	TEXT("Shooter.UI.Stats"),
+	TEXT("Log widget construction counters for every local player."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+		for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			const APlayerController* PlayerController = It->Get();
+			const UShooterUIManager* UIManager = PlayerController
+				                                     ? PlayerController->FindComponentByClass<UShooterUIManager>()
+				                                     : nullptr;
+			if (UIManager)
+			{
+				const FShooterUIStats& Stats = UIManager->GetStats();
+				UE_LOG(LogTemp, Log, TEXT("UI %s: %d widgets created, %d late, %.2f ms total, %.2f ms max"),
+				       *PlayerController->GetName(), Stats.WidgetsCreated, Stats.LateCreations,
+				       Stats.TotalCreateTimeMs, Stats.MaxCreateTimeMs);
+			}
+		}
+	}));
+
+UShooterUIManager::UShooterUIManager()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UShooterUIManager::AddScreen(FName ScreenName, TSoftClassPtr<UUserWidget> WidgetClass)
+{
+	if (!WidgetClass.IsNull())
+	{
+		Screens.Add(ScreenName, WidgetClass);
+	}
+}
+
+void UShooterUIManager::PreloadScreens()
+{
+	if (GetLocalPlayerController() == nullptr)
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> ClassesToLoad;
+	for (const TPair<FName, TSoftClassPtr<UUserWidget>>& Screen : Screens)
+	{
+		if (Screen.Value.IsPending())
+		{
+			ClassesToLoad.Add(Screen.Value.ToSoftObjectPath());
+		}
+	}
+
+	if (ClassesToLoad.Num() == 0)
+	{
+		OnScreenClassesLoaded();
+		return;
+	}
+	LoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		ClassesToLoad, FStreamableDelegate::CreateUObject(this, &UShooterUIManager::OnScreenClassesLoaded));
+}
+
+UUserWidget* UShooterUIManager::ShowScreen(FName ScreenName)
+{
+	UUserWidget* Widget = Widgets.FindRef(ScreenName);
+	if (Widget == nullptr)
+	{
+		// Shown before the preload finished. This is the hitch the preload is there to avoid
+		Widget = CreateScreen(ScreenName);
+		if (Widget == nullptr)
+		{
+			return nullptr;
+		}
+		++Stats.LateCreations;
+	}
+
+	Widget->SetVisibility(ESlateVisibility::SelfHitTestInvisible);
+	return Widget;
+}
+
+void UShooterUIManager::HideScreen(FName ScreenName)
+{
+	if (UUserWidget* Widget = Widgets.FindRef(ScreenName))
+	{
+		Widget->SetVisibility(ESlateVisibility::Collapsed);
+	}
+}
+
+void UShooterUIManager::HideAllScreens()
+{
+	for (const TPair<FName, UUserWidget*>& Widget : Widgets)
+	{
+		if (Widget.Value)
+		{
+			Widget.Value->SetVisibility(ESlateVisibility::Collapsed);
+		}
+	}
+}
+
+bool UShooterUIManager::IsScreenVisible(FName ScreenName) const
+{
+	const UUserWidget* Widget = Widgets.FindRef(ScreenName);
+	return Widget && Widget->GetVisibility() != ESlateVisibility::Collapsed;
+}
+
+void UShooterUIManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (LoadHandle.IsValid())
+	{
+		LoadHandle->CancelHandle();
+		LoadHandle.Reset();
+	}
+	for (const TPair<FName, UUserWidget*>& Widget : Widgets)
+	{
+		if (Widget.Value)
+		{
+			Widget.Value->RemoveFromParent();
+		}
+	}
+	Widgets.Reset();
+	Super::EndPlay(EndPlayReason);
+}
+
+void UShooterUIManager::OnScreenClassesLoaded()
+{
+	LoadHandle.Reset();
+	for (const TPair<FName, TSoftClassPtr<UUserWidget>>& Screen : Screens)
+	{
+		if (!Widgets.Contains(Screen.Key))
+		{
+			CreateScreen(Screen.Key);
+		}
+	}
+}
+
+UUserWidget* UShooterUIManager::CreateScreen(FName ScreenName)
+{
+	APlayerController* PlayerController = GetLocalPlayerController();
+	const TSoftClassPtr<UUserWidget>* WidgetClass = Screens.Find(ScreenName);
+	if (PlayerController == nullptr || WidgetClass == nullptr)
+	{
+		return nullptr;
+	}
+
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterCreateWidget);
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Only loads here when the screen is shown before its preload finished
+	UUserWidget* Widget = CreateWidget(PlayerController, WidgetClass->LoadSynchronous());
+	if (Widget == nullptr)
+	{
+		return nullptr;
+	}
+	Widget->SetVisibility(ESlateVisibility::Collapsed);
+	Widget->AddToViewport(ZOrder);
+	Widgets.Add(ScreenName, Widget);
+
+	const float CreateTimeMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	++Stats.WidgetsCreated;
+	Stats.TotalCreateTimeMs += CreateTimeMs;
+	Stats.MaxCreateTimeMs = FMath::Max(Stats.MaxCreateTimeMs, CreateTimeMs);
+	return Widget;
+}
+
+APlayerController* UShooterUIManager::GetLocalPlayerController() const
+{
+	APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	return PlayerController && PlayerController->IsLocalController() ? PlayerController : nullptr;
+}
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ShooterUIManager.generated.h"
+
+class UUserWidget;
+
+/** Widget construction counters since the manager began play */
+USTRUCT(BlueprintType)
+struct FShooterUIStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = UI)
+	int32 WidgetsCreated{0};
+
+	/** Screens shown before their preload finished, which were built on the spot */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = UI)
+	int32 LateCreations{0};
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = UI)
+	float TotalCreateTimeMs{0.f};
+
+	/** Longest single widget construction, the hitch to watch for */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = UI)
+	float MaxCreateTimeMs{0.f};
+};
+
+/**
+ * Owns the screens of a local player controller. Every registered screen class is loaded asynchronously
+ * and its widget built while the level starts, then added to the viewport collapsed. Showing a screen
+ * only changes its visibility, so nothing is loaded or constructed when the round ends.
+ */
+UCLASS(ClassGroup = UI)
+class SHOOTERTEMPLATE_API UShooterUIManager : public UActorComponent
+{
+	GENERATED_BODY()
+public:
+	UShooterUIManager();
+
+	/** Register a screen before PreloadScreens. Null classes are ignored */
+	void AddScreen(FName ScreenName, TSoftClassPtr<UUserWidget> WidgetClass);
+
+	/** Load the registered screen classes and build their widgets. Does nothing unless the owner is local */
+	void PreloadScreens();
+
+	/**
+	 * Make a screen visible. Built on the spot if its preload hasn't finished
+	 * @return the screen's widget, null for unknown screens or remote controllers
+	 */
+	UFUNCTION(BlueprintCallable, Category = UI)
+	UUserWidget* ShowScreen(FName ScreenName);
+
+	UFUNCTION(BlueprintCallable, Category = UI)
+	void HideScreen(FName ScreenName);
+
+	UFUNCTION(BlueprintCallable, Category = UI)
+	void HideAllScreens();
+
+	UFUNCTION(BlueprintPure, Category = UI)
+	bool IsScreenVisible(FName ScreenName) const;
+
+	FORCEINLINE const FShooterUIStats& GetStats() const { return Stats; }
+
+protected:
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	void OnScreenClassesLoaded();
+
+	/** Build a screen's widget and add it to the viewport collapsed */
+	UUserWidget* CreateScreen(FName ScreenName);
+
+	APlayerController* GetLocalPlayerController() const;
+
+	/** Screens besides the ones the controller registers, e.g. HUD panels */
+	UPROPERTY(EditAnywhere, Category = UI)
+	TMap<FName, TSoftClassPtr<UUserWidget>> Screens;
+
+	/** Z order the screens are added to the viewport with */
+	UPROPERTY(EditAnywhere, Category = UI)
+	int32 ZOrder{10};
+
+	UPROPERTY(Transient)
+	TMap<FName, UUserWidget*> Widgets;
+
+	TSharedPtr<struct FStreamableHandle> LoadHandle;
+
+	FShooterUIStats Stats;
+};
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShotLedger.h"
+
+bool FShotLedger::TakeShotIndex(uint32 ShotIndex)
+{
+	if (ShotIndex != NextShotIndex)
+	{
+		return false;
+	}
+	++NextShotIndex;
+	return true;
+}
+
+bool FShotLedger::RecordShot(uint32 ShotIndex, float FireTime, double MinInterval, const FVector& AimStart,
+                             const FVector& AimDirection, bool bClaimable)
+{
+	// Fire times only move forward, and never faster than the weapon fires
+	if (FireTime < LastFireTime + MinInterval)
+	{
+		return false;
+	}
+	LastFireTime = FireTime;
+
+	FLedgerShot& Shot = Shots[Head];
+	Shot.FireTime = FireTime;
+	Shot.AimStart = AimStart;
+	Shot.AimDirection = AimDirection;
+	Shot.ShotIndex = ShotIndex;
+	Shot.bClaimable = bClaimable;
+	Shot.ClaimedTargets.Reset();
+
+	Head = (Head + 1) % Capacity;
+	Count = FMath::Min(Count + 1, Capacity);
+	return true;
+}
+
+const FLedgerShot* FShotLedger::ClaimHit(float FireTime, const AActor* Target)
+{
+	// Newest first, claims usually follow their shot closely
+	for (int32 Index = 1; Index <= Count; ++Index)
+	{
+		FLedgerShot& Shot = Shots[(Head - Index + Capacity) % Capacity];
+		if (Shot.FireTime != FireTime)
+		{
+			continue;
+		}
+		if (!Shot.bClaimable || Shot.ClaimedTargets.Contains(Target))
+		{
+			return nullptr;
+		}
+		Shot.ClaimedTargets.Add(Target);
+		return &Shot;
+	}
+	return nullptr;
+}
+
+void FShotLedger::Reset()
+{
+	Head = 0;
+	Count = 0;
+	LastFireTime = -DBL_MAX;
+}
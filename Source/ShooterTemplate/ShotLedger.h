@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+
+/** A shot a remote client told the server it fired */
+struct FLedgerShot
+{
+	/** Server world time on the client when the shot was fired. Identifies the shot in hit claims */
+	float FireTime{0.f};
+
+	FVector AimStart{FVector::ZeroVector};
+	FVector AimDirection{FVector::ForwardVector};
+
+	/** The shooter's count of shots before this one. The server derives the pellet pattern from it */
+	uint32 ShotIndex{0};
+
+	/** False for projectile shots, whose rounds the server flies and damages with itself */
+	bool bClaimable{true};
+
+	/** Targets a hit has already been claimed on. A shot hits each target at most once */
+	TArray<const AActor*, TInlineAllocator<4>> ClaimedTargets;
+};
+
+/**
+ * Server-side fire accounting for one remote shooter. The client announces every shot before it claims
+ * hits with it, numbered one after the other, and a shot is only recorded if it comes no sooner after the
+ * previous one than the rate of fire allows. A hit claim has to name a recorded shot, and the server replays
+ * the shot's rays from the record. Shots are kept in a fixed ring, so the oldest drop out as new ones come in.
+ */
+struct SHOOTERTEMPLATE_API FShotLedger
+{
+	/**
+	 * Take the index of an announced shot. False if it doesn't follow the previous one, so the client can't
+	 * pick which pellet pattern it fires. Every announced shot takes one, recorded or not
+	 */
+	bool TakeShotIndex(uint32 ShotIndex);
+
+	/**
+	 * Record a shot. False, and nothing recorded, if it comes sooner than MinInterval after the last one
+	 * @param bClaimable whether hits may be claimed with the shot. Still recorded either way, for the rate of fire
+	 */
+	bool RecordShot(uint32 ShotIndex, float FireTime, double MinInterval, const FVector& AimStart,
+	                const FVector& AimDirection, bool bClaimable);
+
+	/**
+	 * The recorded shot fired at FireTime, with Target marked as claimed. Null if there is no such shot,
+	 * it isn't claimable, or it was already claimed against Target
+	 */
+	const FLedgerShot* ClaimHit(float FireTime, const AActor* Target);
+
+	/** Forget every shot and the rate of fire history. Shot indices carry on, as the client's count does */
+	void Reset();
+
+private:
+	static constexpr int32 Capacity = 32;
+
+	FLedgerShot Shots[Capacity];
+
+	/** Slot the next shot is written to */
+	int32 Head{0};
+	int32 Count{0};
+
+	double LastFireTime{-DBL_MAX};
+
+	/** Index the next announced shot must have */
+	uint32 NextShotIndex{0};
+};
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShotLedger.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FShotLedgerClaimTest, "ShooterTemplate.ShotLedger.Claims",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FShotLedgerClaimTest::RunTest(const FString& Parameters)
+{
+	// Any non-null address works as a target, claims only compare pointers
+	const AActor* TargetA = reinterpret_cast<const AActor*>(0x10);
+	const AActor* TargetB = reinterpret_cast<const AActor*>(0x20);
+	const FVector Start = FVector::ZeroVector;
+	const FVector Direction = FVector::ForwardVector;
+
+	FShotLedger Ledger;
+	TestTrue(TEXT("Hitscan shot recorded"), Ledger.RecordShot(0, 1.f, 0.1, Start, Direction, true));
+	TestFalse(TEXT("Shot faster than the rate of fire rejected"), Ledger.RecordShot(1, 1.05f, 0.1, Start, Direction, true));
+	TestFalse(TEXT("Unrecorded fire time can't be claimed"), Ledger.ClaimHit(1.05f, TargetA) != nullptr);
+
+	TestTrue(TEXT("Hitscan shot claimed"), Ledger.ClaimHit(1.f, TargetA) != nullptr);
+	TestFalse(TEXT("Same target claimed twice"), Ledger.ClaimHit(1.f, TargetA) != nullptr);
+	TestTrue(TEXT("Second target claimed"), Ledger.ClaimHit(1.f, TargetB) != nullptr);
+
+	// A projectile shot counts toward the rate of fire, but its rounds deal the damage
+	TestTrue(TEXT("Projectile shot recorded"), Ledger.RecordShot(2, 1.2f, 0.1, Start, Direction, false));
+	TestFalse(TEXT("Projectile shot can't be claimed"), Ledger.ClaimHit(1.2f, TargetA) != nullptr);
+	TestFalse(TEXT("Shot faster than the projectile shot rejected"), Ledger.RecordShot(3, 1.25f, 0.1, Start, Direction, true));
+
+	// Shot indices, which pick the pellet pattern, have to come one after the other and survive a reset
+	TestTrue(TEXT("First shot index taken"), Ledger.TakeShotIndex(0));
+	TestFalse(TEXT("Repeated shot index rejected"), Ledger.TakeShotIndex(0));
+	TestFalse(TEXT("Skipped shot index rejected"), Ledger.TakeShotIndex(2));
+	Ledger.Reset();
+	TestTrue(TEXT("Next shot index taken after a reset"), Ledger.TakeShotIndex(1));
+	return true;
+}
+
+#endif
@@ -0,0 +1,335 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShotTraceSubsystem.h"
+
+#include "CrowdSubsystem.h"
+#include "GameplayEventBus.h"
+#include "HitboxSubsystem.h"
+#include "PelletPattern.h"
+#include "ShooterTemplate.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+
+static TAutoConsoleVariable<int32> CVarShotTraceSynchronous(
+	TEXT("Shooter.ShotTrace.Synchronous"),
+	0,
+	TEXT("0: hitscan shots are batched and traced off the game thread, resolved next frame.\n")
+	TEXT("1: every shot is traced and resolved inline on the game thread."));
+
+/** Publish a traced shot, one event per pellet. Called from whichever thread traced it */
+static void PublishShot(UGameplayEventBus* EventBus, const FShotRequest& Request, const FShotResult& Result)
+{
+	if (EventBus == nullptr)
+	{
+		return;
+	}
+
+	for (const FShotRayResult& Ray : Result.GetRays())
+	{
+		FShooterShotEvent Event;
+		Event.Shooter = Request.Shooter;
+		Event.Start = Request.bTraceFromMuzzle ? Request.MuzzleTransform.GetLocation() : Request.AimStart;
+		Event.End = Ray.BeamEnd;
+		Event.HitActor = Ray.Hit.Actor;
+		Event.bHit = Ray.bBlockingHit;
+		EventBus->Publish(Event);
+	}
+}
+
+/** Point damage to the actor a ray hit */
+static void ApplyRayDamage(const FShotRequest& Request, const FShotRayResult& Ray, float Damage)
+{
+	FPointDamageEvent DamageEvent(Damage, Ray.Hit, Ray.Direction, nullptr);
+	Ray.Hit.GetActor()->TakeDamage(Damage, DamageEvent, Request.Instigator.Get(), Request.DamageCauser.Get());
+}
+
+/**
+ * Damage the nearest crowd agent that isn't an actor along a ray. Agents like that have no collision, so
+ * one stops the ray short of whatever the trace hit
+ */
+static bool ApplyRayDamageToCrowd(UCrowdSubsystem* Crowd, const FShotRequest& Request, const FShotRayResult& Ray)
+{
+	int32 AgentId;
+	FVector Location;
+	if (Crowd == nullptr || !Crowd->RaycastFragments(Request.AimStart, Ray.BeamEnd, AgentId, Location))
+	{
+		return false;
+	}
+	Crowd->ApplyDamageToAgent(AgentId, Request.Damage, Request.Instigator.Get(), Request.DamageCauser.Get());
+	return true;
+}
+
+/** Damage whatever the shot hit. Each actor takes the damage of every pellet that hit it in one call */
+static void ApplyShotDamage(UCrowdSubsystem* Crowd, const FShotRequest& Request, const FShotResult& Result)
+{
+	if (Result.Pellets.Num() == 0)
+	{
+		if (ApplyRayDamageToCrowd(Crowd, Request, Result))
+		{
+			return;
+		}
+		if (Result.bBlockingHit && Result.Hit.GetActor() != nullptr)
+		{
+			ApplyRayDamage(Request, Result, Request.Damage * Result.DamageMultiplier);
+		}
+		return;
+	}
+
+	// Index of the first pellet on each actor, which the damage event reports, and the summed damage
+	TArray<TPair<int32, float>, TInlineAllocator<16>> DamageByActor;
+	for (int32 Pellet = 0; Pellet < Result.Pellets.Num(); ++Pellet)
+	{
+		const FShotRayResult& Ray = Result.Pellets[Pellet];
+		const AActor* HitActor = Ray.Hit.GetActor();
+		if (ApplyRayDamageToCrowd(Crowd, Request, Ray) || !Ray.bBlockingHit || HitActor == nullptr)
+		{
+			continue;
+		}
+
+		const float Damage = Request.Damage * Ray.DamageMultiplier;
+		TPair<int32, float>* Entry = DamageByActor.FindByPredicate([&Result, HitActor](const TPair<int32, float>& Other)
+		{
+			return Result.Pellets[Other.Key].Hit.GetActor() == HitActor;
+		});
+		if (Entry)
+		{
+			Entry->Value += Damage;
+		}
+		else
+		{
+			DamageByActor.Emplace(Pellet, Damage);
+		}
+	}
+	for (const TPair<int32, float>& Entry : DamageByActor)
+	{
+		ApplyRayDamage(Request, Result.Pellets[Entry.Key], Entry.Value);
+	}
+}
+
+/** Trace one segment of a shot. Characters are tested on their hitboxes, up to the level hit */
+static bool TraceShotSegment(const UWorld* World, const UHitboxSubsystem* Hitboxes, const FShotRequest& Request,
+                             const FVector& Start, const FVector& End, const FCollisionQueryParams& Params,
+                             FHitResult& OutHit, float& OutDamageMultiplier)
+{
+	// Pawns' physics assets are left to the hitboxes
+	FCollisionResponseParams ResponseParams;
+	if (Hitboxes)
+	{
+		ResponseParams.CollisionResponse.SetResponse(ECollisionChannel::ECC_Pawn, ECR_Ignore);
+	}
+
+	FHitResult LevelHit;
+	const bool bLevelHit = World->LineTraceSingleByChannel(LevelHit, Start, End, Request.TraceChannel, Params,
+	                                                       ResponseParams);
+
+	FHitboxHit HitboxHit;
+	if (Hitboxes && Hitboxes->Raycast(Start, bLevelHit ? LevelHit.Location : End, HitboxHit, Request.Shooter.Get()))
+	{
+		OutHit = FHitResult();
+		OutHit.bBlockingHit = true;
+		OutHit.Actor = HitboxHit.Character;
+		OutHit.Component = HitboxHit.Mesh;
+		OutHit.BoneName = HitboxHit.Bone;
+		OutHit.Location = OutHit.ImpactPoint = HitboxHit.Location;
+		OutHit.Normal = OutHit.ImpactNormal = HitboxHit.Normal;
+		OutHit.TraceStart = Start;
+		OutHit.TraceEnd = End;
+		OutHit.Distance = HitboxHit.Distance;
+		OutHit.Time = HitboxHit.Distance / FMath::Max(FVector::Dist(Start, End), KINDA_SMALL_NUMBER);
+		OutDamageMultiplier = Hitboxes->GetDamageMultiplier(HitboxHit.Region);
+		return true;
+	}
+
+	if (bLevelHit)
+	{
+		OutHit = LevelHit;
+		OutDamageMultiplier = 1.f;
+	}
+	return bLevelHit;
+}
+
+void UShotTraceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UShotTraceSubsystem::OnWorldTickStart);
+}
+
+void UShotTraceSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+
+	// The world is going away, so drop the results instead of resolving them
+	WaitForInFlightShots();
+	InFlightShots.Reset();
+	InFlightResults.Reset();
+	PendingShots.Reset();
+
+	Super::Deinitialize();
+}
+
+void UShotTraceSubsystem::QueueShot(FShotRequest&& Request)
+{
+	if (IsSynchronous())
+	{
+		const FShotResult Result = TraceShot(GetWorld(), GetHitboxes(), Request);
+		PublishShot(GetWorld()->GetSubsystem<UGameplayEventBus>(), Request, Result);
+		ResolveShot(Request, Result);
+		return;
+	}
+	PendingShots.Add(MoveTemp(Request));
+}
+
+/** Trace one ray of a shot along AimDirection, from the crosshair and then from the muzzle */
+static void TraceShotRay(const UWorld* World, const UHitboxSubsystem* Hitboxes, const FShotRequest& Request,
+                         const FCollisionQueryParams& Params, const FVector& AimDirection, FShotRayResult& OutRay)
+{
+	const FVector AimEnd{Request.AimStart + AimDirection * Request.Range};
+	OutRay.Direction = AimDirection;
+	OutRay.BeamEnd = AimEnd;
+
+	// Trace outward from the crosshair
+	FHitResult AimHit;
+	if (TraceShotSegment(World, Hitboxes, Request, Request.AimStart, AimEnd, Params, AimHit, OutRay.DamageMultiplier))
+	{
+		OutRay.BeamEnd = AimHit.Location;
+		OutRay.Hit = AimHit;
+		OutRay.bBlockingHit = true;
+	}
+
+	// Second trace from the gun barrel, in case something sits between the barrel and the aim point
+	if (Request.bTraceFromMuzzle)
+	{
+		FHitResult MuzzleHit;
+		if (TraceShotSegment(World, Hitboxes, Request, Request.MuzzleTransform.GetLocation(), OutRay.BeamEnd, Params,
+		                     MuzzleHit, OutRay.DamageMultiplier))
+		{
+			OutRay.BeamEnd = MuzzleHit.Location;
+			OutRay.Hit = MuzzleHit;
+			OutRay.bBlockingHit = true;
+		}
+	}
+}
+
+FShotResult UShotTraceSubsystem::TraceShot(const UWorld* World, const UHitboxSubsystem* Hitboxes,
+                                           const FShotRequest& Request)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterShotTrace);
+	const int32 NumPellets = FMath::Max(Request.NumPellets, 1);
+	SHOOTER_INC_COUNTER(STAT_ShooterTraces, NumPellets * (Request.bTraceFromMuzzle ? 2 : 1));
+	FShotResult Result;
+	Result.Direction = Request.AimDirection;
+	Result.BeamEnd = Request.AimStart + Request.AimDirection * Request.Range;
+	if (World == nullptr)
+	{
+		return Result;
+	}
+
+	FCollisionQueryParams Params;
+	Params.AddIgnoredActor(Request.Shooter.Get());
+	Params.AddIgnoredActor(Request.DamageCauser.Get());
+
+	if (NumPellets == 1)
+	{
+		TraceShotRay(World, Hitboxes, Request, Params, Request.AimDirection, Result);
+		return Result;
+	}
+
+	// Every pellet of the pattern in this one pass
+	FPelletDirections Directions;
+	FPelletPattern::Generate(Request.SpreadSeed, NumPellets, Request.SpreadAngle, Request.AimDirection, Directions);
+	Result.Pellets.SetNum(Directions.Num());
+	for (int32 Pellet = 0; Pellet < Directions.Num(); ++Pellet)
+	{
+		TraceShotRay(World, Hitboxes, Request, Params, Directions[Pellet], Result.Pellets[Pellet]);
+	}
+	static_cast<FShotRayResult&>(Result) = Result.Pellets[0];
+	return Result;
+}
+
+bool UShotTraceSubsystem::IsSynchronous()
+{
+	return CVarShotTraceSynchronous.GetValueOnGameThread() != 0;
+}
+
+void UShotTraceSubsystem::Tick(float DeltaTime)
+{
+	// Ticks after every actor, so this frame's shots are all queued by now
+	if (PendingShots.Num() == 0 || InFlightTask.IsValid())
+	{
+		return;
+	}
+
+	Swap(InFlightShots, PendingShots);
+	InFlightResults.SetNum(InFlightShots.Num());
+
+	const UWorld* World = GetWorld();
+	UGameplayEventBus* EventBus = World->GetSubsystem<UGameplayEventBus>();
+	const UHitboxSubsystem* Hitboxes = GetHitboxes();
+	const TArray<FShotRequest>* Shots = &InFlightShots;
+	TArray<FShotResult>* Results = &InFlightResults;
+	InFlightTask = FFunctionGraphTask::CreateAndDispatchWhenReady([World, EventBus, Hitboxes, Shots, Results]()
+	{
+		for (int32 Index = 0; Index < Shots->Num(); ++Index)
+		{
+			(*Results)[Index] = TraceShot(World, Hitboxes, (*Shots)[Index]);
+			PublishShot(EventBus, (*Shots)[Index], (*Results)[Index]);
+		}
+	}, TStatId(), nullptr, ENamedThreads::AnyHiPriThreadNormalTask);
+}
+
+bool UShotTraceSubsystem::IsTickable() const
+{
+	return !IsTemplate() && PendingShots.Num() > 0;
+}
+
+TStatId UShotTraceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShotTraceSubsystem, STATGROUP_Tickables);
+}
+
+void UShotTraceSubsystem::OnWorldTickStart(UWorld* TickingWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterShotResolve);
+	if (TickingWorld != GetWorld() || !InFlightTask.IsValid())
+	{
+		return;
+	}
+
+	WaitForInFlightShots();
+
+	// Resolving can queue new shots, which land in PendingShots for this frame's batch
+	TArray<FShotRequest> Shots = MoveTemp(InFlightShots);
+	TArray<FShotResult> Results = MoveTemp(InFlightResults);
+	for (int32 Index = 0; Index < Shots.Num(); ++Index)
+	{
+		ResolveShot(Shots[Index], Results[Index]);
+	}
+}
+
+const UHitboxSubsystem* UShotTraceSubsystem::GetHitboxes() const
+{
+	const UHitboxSubsystem* Hitboxes = GetWorld()->GetSubsystem<UHitboxSubsystem>();
+	return Hitboxes && Hitboxes->HasCharacters() ? Hitboxes : nullptr;
+}
+
+void UShotTraceSubsystem::WaitForInFlightShots()
+{
+	if (InFlightTask.IsValid())
+	{
+		FTaskGraphInterface::Get().WaitUntilTaskCompletes(InFlightTask, ENamedThreads::GameThread);
+		InFlightTask = nullptr;
+	}
+}
+
+void UShotTraceSubsystem::ResolveShot(const FShotRequest& Request, const FShotResult& Result) const
+{
+	// Deal damage to the hit actors. Clients have to ask the server instead
+	if (Request.Damage > 0.f && !GetWorld()->IsNetMode(NM_Client))
+	{
+		ApplyShotDamage(GetWorld()->GetSubsystem<UCrowdSubsystem>(), Request, Result);
+	}
+
+	Request.OnResolved.ExecuteIfBound(Request, Result);
+}
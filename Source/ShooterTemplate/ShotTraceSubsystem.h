@@ -0,0 +1,151 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShotTraceSubsystem.generated.h"
+
+class UHitboxSubsystem;
+struct FShotRequest;
+struct FShotResult;
+
+/** Called on the game thread once a queued shot has been traced */
+DECLARE_DELEGATE_TwoParams(FOnShotResolved, const FShotRequest& /*Request*/, const FShotResult& /*Result*/);
+
+/** A single hitscan shot waiting to be traced */
+struct FShotRequest
+{
+	/** Actor that fired the shot. Ignored by the traces */
+	TWeakObjectPtr<AActor> Shooter;
+
+	/** Actor passed to TakeDamage as the damage causer. Ignored by the traces */
+	TWeakObjectPtr<AActor> DamageCauser;
+
+	/** Controller passed to TakeDamage as the instigator */
+	TWeakObjectPtr<AController> Instigator;
+
+	/** Start of the aim (crosshair) ray */
+	FVector AimStart{FVector::ZeroVector};
+
+	/** Normalized direction of the aim ray */
+	FVector AimDirection{FVector::ForwardVector};
+
+	/** Length of the aim ray */
+	float Range{50'000.f};
+
+	/** Barrel transform at the time of firing */
+	FTransform MuzzleTransform;
+
+	/** When set, a second trace runs from the muzzle to the aim hit, like the original beam logic */
+	bool bTraceFromMuzzle{false};
+
+	ECollisionChannel TraceChannel{ECC_Visibility};
+
+	/** Damage applied to the hit actor on resolve, per pellet. Zero means no damage. Never applied on clients */
+	float Damage{0.f};
+
+	/** Rays in the shot. Above one, the pellets follow the seeded spread pattern around the aim ray */
+	int32 NumPellets{1};
+
+	/** Half angle of the pellet spread, in degrees */
+	float SpreadAngle{0.f};
+
+	/** Picks the pellet pattern. The same seed always gives the same pattern */
+	uint32 SpreadSeed{0};
+
+	/** Server world time when the shot was fired, for lag compensated hit claims */
+	float FireTime{0.f};
+
+	/** Impact FX and other per-shot feedback */
+	FOnShotResolved OnResolved;
+};
+
+/** Where one ray of a shot ended */
+struct FShotRayResult
+{
+	/** Normalized direction of the ray */
+	FVector Direction{FVector::ForwardVector};
+
+	/** Impact point, or the end of the aim ray if nothing was hit */
+	FVector BeamEnd{FVector::ZeroVector};
+
+	/** The hit that ended the ray. Only meaningful when bBlockingHit is set */
+	FHitResult Hit;
+
+	bool bBlockingHit{false};
+
+	/** Scales the request's damage by the hitbox region hit. 1 for anything but a hitbox */
+	float DamageMultiplier{1.f};
+};
+
+/** Outcome of a traced shot. For a multi-pellet shot the ray fields are those of pellet 0, on the aim line */
+struct FShotResult : public FShotRayResult
+{
+	/** Every pellet of a multi-pellet shot, in pattern order. Empty for single-ray shots */
+	TArray<FShotRayResult> Pellets;
+
+	/** The pellets, or the one ray of a single-ray shot */
+	TArrayView<const FShotRayResult> GetRays() const
+	{
+		return Pellets.Num() > 0 ? TArrayView<const FShotRayResult>(Pellets) : TArrayView<const FShotRayResult>(this, 1);
+	}
+};
+
+/**
+ * Collects all hitscan shots fired during a frame and traces them as one batch off the game thread.
+ * The batch is kicked at the end of the frame and resolved (damage, then OnResolved) at the start
+ * of the next one. Clients only get the FX callback; damage is left to the server. Characters are hit
+ * on their per-bone hitboxes, and the region hit scales the damage. The pellets of a multi-pellet shot
+ * are traced together in the same batch, and each actor they hit takes their summed damage at once.
+ * On the server, crowd agents that aren't actors are hit too, on the resolve.
+ * Set Shooter.ShotTrace.Synchronous to 1 to trace and resolve every shot inline.
+ */
+UCLASS()
+class SHOOTERTEMPLATE_API UShotTraceSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Queue a shot for the current frame's batch, or resolve it right away in synchronous mode */
+	void QueueShot(FShotRequest&& Request);
+
+	/**
+	 * Trace a shot on the calling thread. Safe to call from a worker while the batch is in flight
+	 * @param Hitboxes when set, characters are hit on their hitboxes instead of their collision
+	 */
+	static FShotResult TraceShot(const UWorld* World, const UHitboxSubsystem* Hitboxes, const FShotRequest& Request);
+
+	/** True when shots are traced inline instead of batched */
+	static bool IsSynchronous();
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+private:
+	/** Wait for the batch kicked last frame and resolve it */
+	void OnWorldTickStart(UWorld* TickingWorld, ELevelTick TickType, float DeltaSeconds);
+
+	void WaitForInFlightShots();
+
+	/** Hitboxes for this frame's shots, or null to trace characters' collision */
+	const UHitboxSubsystem* GetHitboxes() const;
+	void ResolveShot(const FShotRequest& Request, const FShotResult& Result) const;
+
+	/** Shots queued this frame */
+	TArray<FShotRequest> PendingShots;
+
+	/** Shots being traced by InFlightTask, with their results at the same index */
+	TArray<FShotRequest> InFlightShots;
+	TArray<FShotResult> InFlightResults;
+
+	FGraphEventRef InFlightTask;
+
+	FDelegateHandle WorldTickStartHandle;
+};
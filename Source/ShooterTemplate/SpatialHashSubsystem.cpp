@@ -0,0 +1,298 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SpatialHashSubsystem.h"
+
+#include "ShooterTemplate.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+static FAutoConsoleCommandWithWorld SpatialHashStatsCommand(
+	TEXT("Shooter.SpatialHash.Stats"),
+	TEXT("Log the actors, occupied cells and queries of the spatial hash for the current world."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		const USpatialHashSubsystem* SpatialHash = World ? World->GetSubsystem<USpatialHashSubsystem>() : nullptr;
+		if (SpatialHash)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Spatial hash: %d actors in %d cells, %lld queries"),
+			       SpatialHash->GetNumActors(), SpatialHash->GetNumCells(), SpatialHash->GetNumQueries());
+		}
+	}));
+
+void USpatialHashSubsystem::Deinitialize()
+{
+	Actors.Empty();
+	Keys.Empty();
+	LocationsX.Empty();
+	LocationsY.Empty();
+	LocationsZ.Empty();
+	EntryCells.Empty();
+	Cells.Empty();
+	IndexByActor.Empty();
+	Super::Deinitialize();
+}
+
+void USpatialHashSubsystem::RegisterActor(AActor* Actor)
+{
+	if (Actor == nullptr || IndexByActor.Contains(Actor))
+	{
+		return;
+	}
+
+	const FVector Location = Actor->GetActorLocation();
+	const FIntPoint Cell = CellAt(Location.X, Location.Y);
+	const int32 Index = Actors.Add(Actor);
+	Keys.Add(Actor);
+	LocationsX.Add(Location.X);
+	LocationsY.Add(Location.Y);
+	LocationsZ.Add(Location.Z);
+	EntryCells.Add(Cell);
+	Cells.FindOrAdd(Cell).Add(Index);
+	IndexByActor.Add(Actor, Index);
+}
+
+void USpatialHashSubsystem::UnregisterActor(const AActor* Actor)
+{
+	const int32* Index = IndexByActor.Find(Actor);
+	if (Index)
+	{
+		RemoveEntry(*Index);
+	}
+}
+
+void USpatialHashSubsystem::QueryRadius(const FVector& Origin, float Radius, TArray<AActor*>& OutActors) const
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterSpatialQuery);
+	FindMatches(Origin, Radius, FVector::ZeroVector, 0.f);
+	for (const FSpatialMatch& Match : Matches)
+	{
+		if (AActor* Actor = Actors[Match.Entry].Get())
+		{
+			OutActors.Add(Actor);
+		}
+	}
+}
+
+void USpatialHashSubsystem::QueryCone(const FVector& Origin, const FVector& Direction, float HalfAngleDegrees,
+                                      float Range, TArray<AActor*>& OutActors) const
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterSpatialQuery);
+	const float ConeCos = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(HalfAngleDegrees, 0.f, 90.f)));
+	FindMatches(Origin, Range, Direction.GetSafeNormal(), FMath::Max(FMath::Square(ConeCos), SMALL_NUMBER));
+	for (const FSpatialMatch& Match : Matches)
+	{
+		if (AActor* Actor = Actors[Match.Entry].Get())
+		{
+			OutActors.Add(Actor);
+		}
+	}
+}
+
+void USpatialHashSubsystem::QueryNearest(const FVector& Origin, float MaxRadius, int32 MaxResults,
+                                         TArray<AActor*>& OutActors, TFunctionRef<bool(const AActor*)> Filter) const
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterSpatialQuery);
+	FindMatches(Origin, MaxRadius, FVector::ZeroVector, 0.f);
+	Matches.Sort([](const FSpatialMatch& A, const FSpatialMatch& B)
+	{
+		return A.DistanceSquared < B.DistanceSquared;
+	});
+
+	int32 NumFound = 0;
+	for (const FSpatialMatch& Match : Matches)
+	{
+		AActor* Actor = Actors[Match.Entry].Get();
+		if (Actor && Filter(Actor))
+		{
+			OutActors.Add(Actor);
+			if (++NumFound >= MaxResults)
+			{
+				break;
+			}
+		}
+	}
+}
+
+void USpatialHashSubsystem::Tick(float DeltaTime)
+{
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterSpatialHash);
+	for (int32 Index = Actors.Num() - 1; Index >= 0; --Index)
+	{
+		const AActor* Actor = Actors[Index].Get();
+		if (Actor == nullptr)
+		{
+			RemoveEntry(Index);
+			continue;
+		}
+
+		const FVector Location = Actor->GetActorLocation();
+		LocationsX[Index] = Location.X;
+		LocationsY[Index] = Location.Y;
+		LocationsZ[Index] = Location.Z;
+
+		// Most actors stay in their cell from one frame to the next
+		const FIntPoint Cell = CellAt(Location.X, Location.Y);
+		if (Cell != EntryCells[Index])
+		{
+			RemoveFromCell(EntryCells[Index], Index);
+			Cells.FindOrAdd(Cell).Add(Index);
+			EntryCells[Index] = Cell;
+		}
+	}
+}
+
+bool USpatialHashSubsystem::IsTickable() const
+{
+	return !IsTemplate() && Actors.Num() > 0;
+}
+
+TStatId USpatialHashSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USpatialHashSubsystem, STATGROUP_Tickables);
+}
+
+void USpatialHashSubsystem::FindMatches(const FVector& Origin, float Radius, const FVector& ConeDirection,
+                                        float ConeCosSquared) const
+{
+	check(IsInGameThread());
+	++NumQueries;
+	Matches.Reset();
+	if (Actors.Num() == 0 || Radius <= 0.f)
+	{
+		return;
+	}
+
+	// Candidates from the covered cells, unless there are fewer entries than cells to look up
+	const FIntPoint MinCell = CellAt(Origin.X - Radius, Origin.Y - Radius);
+	const FIntPoint MaxCell = CellAt(Origin.X + Radius, Origin.Y + Radius);
+	const int64 NumCoveredCells = static_cast<int64>(MaxCell.X - MinCell.X + 1) * (MaxCell.Y - MinCell.Y + 1);
+	const float* X = LocationsX.GetData();
+	const float* Y = LocationsY.GetData();
+	const float* Z = LocationsZ.GetData();
+	const int32* Entries = nullptr;
+	int32 NumCandidates = Actors.Num();
+	if (NumCoveredCells < Actors.Num())
+	{
+		CandidateEntries.Reset();
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+			{
+				if (const TArray<int32, TInlineAllocator<8>>* Cell = Cells.Find(FIntPoint(CellX, CellY)))
+				{
+					CandidateEntries.Append(*Cell);
+				}
+			}
+		}
+
+		NumCandidates = CandidateEntries.Num();
+		CandidatesX.SetNumUninitialized(NumCandidates, false);
+		CandidatesY.SetNumUninitialized(NumCandidates, false);
+		CandidatesZ.SetNumUninitialized(NumCandidates, false);
+		for (int32 Candidate = 0; Candidate < NumCandidates; ++Candidate)
+		{
+			CandidatesX[Candidate] = LocationsX[CandidateEntries[Candidate]];
+			CandidatesY[Candidate] = LocationsY[CandidateEntries[Candidate]];
+			CandidatesZ[Candidate] = LocationsZ[CandidateEntries[Candidate]];
+		}
+		X = CandidatesX.GetData();
+		Y = CandidatesY.GetData();
+		Z = CandidatesZ.GetData();
+		Entries = CandidateEntries.GetData();
+	}
+
+	// In range, and in front of the cone's plane with cos^2 of the angle at least ConeCosSquared.
+	// A zero direction and cosine make the cone test pass for everything
+	const float RadiusSquared = FMath::Square(Radius);
+	const VectorRegister OX = VectorSetFloat1(Origin.X);
+	const VectorRegister OY = VectorSetFloat1(Origin.Y);
+	const VectorRegister OZ = VectorSetFloat1(Origin.Z);
+	const VectorRegister DX = VectorSetFloat1(ConeDirection.X);
+	const VectorRegister DY = VectorSetFloat1(ConeDirection.Y);
+	const VectorRegister DZ = VectorSetFloat1(ConeDirection.Z);
+	const VectorRegister VRadiusSquared = VectorSetFloat1(RadiusSquared);
+	const VectorRegister VConeCosSquared = VectorSetFloat1(ConeCosSquared);
+
+	int32 Candidate = 0;
+	for (; Candidate + 4 <= NumCandidates; Candidate += 4)
+	{
+		const VectorRegister OffX = VectorSubtract(VectorLoad(X + Candidate), OX);
+		const VectorRegister OffY = VectorSubtract(VectorLoad(Y + Candidate), OY);
+		const VectorRegister OffZ = VectorSubtract(VectorLoad(Z + Candidate), OZ);
+		const VectorRegister DistanceSquared =
+			VectorMultiplyAdd(OffX, OffX, VectorMultiplyAdd(OffY, OffY, VectorMultiply(OffZ, OffZ)));
+		const VectorRegister Dot = VectorMultiplyAdd(OffX, DX, VectorMultiplyAdd(OffY, DY, VectorMultiply(OffZ, DZ)));
+
+		const VectorRegister InRange = VectorCompareGE(VRadiusSquared, DistanceSquared);
+		const VectorRegister InFront = VectorCompareGE(Dot, VectorZero());
+		const VectorRegister InCone = VectorCompareGE(VectorMultiply(Dot, Dot),
+		                                              VectorMultiply(VConeCosSquared, DistanceSquared));
+		uint32 Lanes = VectorMaskBits(VectorBitwiseAnd(InRange, VectorBitwiseAnd(InFront, InCone)));
+		if (Lanes == 0)
+		{
+			continue;
+		}
+
+		float LaneDistanceSquared[4];
+		VectorStore(DistanceSquared, LaneDistanceSquared);
+		while (Lanes != 0)
+		{
+			const int32 Lane = FMath::CountTrailingZeros(Lanes);
+			Lanes &= Lanes - 1;
+			Matches.Add({Entries ? Entries[Candidate + Lane] : Candidate + Lane, LaneDistanceSquared[Lane]});
+		}
+	}
+
+	// Leftovers past the last full vector
+	for (; Candidate < NumCandidates; ++Candidate)
+	{
+		const FVector Offset(X[Candidate] - Origin.X, Y[Candidate] - Origin.Y, Z[Candidate] - Origin.Z);
+		const float DistanceSquared = Offset.SizeSquared();
+		const float Dot = Offset | ConeDirection;
+		if (DistanceSquared <= RadiusSquared && Dot >= 0.f && Dot * Dot >= ConeCosSquared * DistanceSquared)
+		{
+			Matches.Add({Entries ? Entries[Candidate] : Candidate, DistanceSquared});
+		}
+	}
+}
+
+FIntPoint USpatialHashSubsystem::CellAt(float X, float Y) const
+{
+	return FIntPoint(FMath::FloorToInt(X / CellSize), FMath::FloorToInt(Y / CellSize));
+}
+
+void USpatialHashSubsystem::RemoveEntry(int32 Index)
+{
+	RemoveFromCell(EntryCells[Index], Index);
+	IndexByActor.Remove(Keys[Index]);
+
+	// The last entry takes this one's place, so its cell and map entries point at the new index
+	const int32 LastIndex = Actors.Num() - 1;
+	if (Index != LastIndex)
+	{
+		TArray<int32, TInlineAllocator<8>>& LastCell = Cells.FindChecked(EntryCells[LastIndex]);
+		LastCell[LastCell.Find(LastIndex)] = Index;
+		IndexByActor.Add(Keys[LastIndex], Index);
+	}
+
+	Actors.RemoveAtSwap(Index, 1, false);
+	Keys.RemoveAtSwap(Index, 1, false);
+	LocationsX.RemoveAtSwap(Index, 1, false);
+	LocationsY.RemoveAtSwap(Index, 1, false);
+	LocationsZ.RemoveAtSwap(Index, 1, false);
+	EntryCells.RemoveAtSwap(Index, 1, false);
+}
+
+void USpatialHashSubsystem::RemoveFromCell(const FIntPoint& Cell, int32 Index)
+{
+	TArray<int32, TInlineAllocator<8>>* Entries = Cells.Find(Cell);
+	if (Entries)
+	{
+		Entries->RemoveSingleSwap(Index, false);
+		if (Entries->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "SpatialHashSubsystem.generated.h"
+
+/**
+ * Uniform grid of every damageable actor, hashed by cell on the XY plane, for "who is near here"
+ * queries without iterating actors. Health components register their owners. Locations are kept in
+ * structure-of-arrays buffers and refreshed once per frame, and an actor only moves between cells when
+ * it crosses a cell border. Queries gather the candidates of the covered cells, or every entry when
+ * that is fewer, and filter them by distance four at a time. Game thread only.
+ */
+UCLASS(Config = Game)
+class SHOOTERTEMPLATE_API USpatialHashSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+public:
+	virtual void Deinitialize() override;
+
+	void RegisterActor(AActor* Actor);
+	void UnregisterActor(const AActor* Actor);
+
+	/** Actors within Radius of Origin, in no particular order */
+	void QueryRadius(const FVector& Origin, float Radius, TArray<AActor*>& OutActors) const;
+
+	/** Actors within Range of Origin and HalfAngleDegrees of Direction. Half angles are clamped to 90 */
+	void QueryCone(const FVector& Origin, const FVector& Direction, float HalfAngleDegrees, float Range,
+	               TArray<AActor*>& OutActors) const;
+
+	/** Up to MaxResults actors that pass Filter within MaxRadius of Origin, nearest first */
+	void QueryNearest(const FVector& Origin, float MaxRadius, int32 MaxResults, TArray<AActor*>& OutActors,
+	                  TFunctionRef<bool(const AActor*)> Filter) const;
+
+	FORCEINLINE int32 GetNumActors() const { return Actors.Num(); }
+	FORCEINLINE int32 GetNumCells() const { return Cells.Num(); }
+	FORCEINLINE int64 GetNumQueries() const { return NumQueries; }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	virtual TStatId GetStatId() const override;
+
+private:
+	struct FSpatialMatch
+	{
+		int32 Entry;
+		float DistanceSquared;
+	};
+
+	/** Entries within Radius, and within the cone when ConeCosSquared is above zero, into Matches */
+	void FindMatches(const FVector& Origin, float Radius, const FVector& ConeDirection, float ConeCosSquared) const;
+
+	FIntPoint CellAt(float X, float Y) const;
+
+	void RemoveEntry(int32 Index);
+	void RemoveFromCell(const FIntPoint& Cell, int32 Index);
+
+	/** Width of a grid cell. About the radius of a typical query works best */
+	UPROPERTY(Config)
+	float CellSize{1000.f};
+
+	/** Registered actors, one entry per array at the same index. Keys stay valid for the map after a destroy */
+	TArray<TWeakObjectPtr<AActor>> Actors;
+	TArray<const AActor*> Keys;
+	TArray<float> LocationsX;
+	TArray<float> LocationsY;
+	TArray<float> LocationsZ;
+	TArray<FIntPoint> EntryCells;
+
+	/** Entries in each occupied cell */
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<8>>> Cells;
+
+	TMap<const AActor*, int32> IndexByActor;
+
+	/** Per-query scratch, reused */
+	mutable TArray<int32> CandidateEntries;
+	mutable TArray<float> CandidatesX;
+	mutable TArray<float> CandidatesY;
+	mutable TArray<float> CandidatesZ;
+	mutable TArray<FSpatialMatch> Matches;
+
+	mutable int64 NumQueries{0};
+};
@@ -0,0 +1,210 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Async/Async.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Components/ActorComponent.h"
+#include "GameFramework/Actor.h"
+#include "Stats/StatsData.h"
+
+#if !UE_BUILD_SHIPPING
+
+namespace TickAudit
+{
+	struct FEntry
+	{
+		FString Name;
+		FString ClassName;
+		float Interval;
+		ETickingGroup TickGroup;
+
+		/** Raw name of the object's cycle stat, which its tick function runs under. None without stats */
+		FName StatName;
+
+		/** Cycles spent in the stat over the capture */
+		uint64 Cycles{0};
+	};
+
+	/** Tick functions found when the audit started, filled in from the stats thread as frames come in */
+	struct FCapture
+	{
+		TArray<FEntry> Entries;
+		TMap<FName, int32> EntryByStat;
+		int32 NumFrames{0};
+		int32 FramesLeft{0};
+		FDelegateHandle NewFrameHandle;
+	};
+
+	/** Closest native class, so blueprint subclasses count as the module class they derive from */
+	UClass* FindNativeClass(UClass* Class)
+	{
+		while (Class && !Class->HasAnyClassFlags(CLASS_Native))
+		{
+			Class = Class->GetSuperClass();
+		}
+		return Class;
+	}
+
+	void AddEntry(FCapture& Capture, const UObject* Object, FString Name, const FTickFunction& TickFunction)
+	{
+		FEntry& Entry = Capture.Entries.AddDefaulted_GetRef();
+		Entry.Name = MoveTemp(Name);
+		Entry.ClassName = Object->GetClass()->GetName();
+		Entry.Interval = TickFunction.TickInterval;
+		Entry.TickGroup = TickFunction.TickGroup;
+#if STATS
+		// Created now if it doesn't exist yet, so the first captured frame already counts it
+		Entry.StatName = Object->GetStatID(true).GetName();
+		if (!Entry.StatName.IsNone())
+		{
+			Capture.EntryByStat.Add(Entry.StatName, Capture.Entries.Num() - 1);
+		}
+#endif
+	}
+
+	void Report(FCapture& Capture)
+	{
+		const bool bHasCost = Capture.NumFrames > 0;
+		auto GetCostMs = [&Capture](const FEntry& Entry)
+		{
+			return FPlatformTime::GetSecondsPerCycle64() * Entry.Cycles * 1000.0 / FMath::Max(Capture.NumFrames, 1);
+		};
+		Capture.Entries.Sort([](const FEntry& A, const FEntry& B) { return A.Cycles > B.Cycles; });
+
+		double TotalMs = 0.0;
+		for (const FEntry& Entry : Capture.Entries)
+		{
+			const FString Group = UEnum::GetValueAsString(Entry.TickGroup);
+			if (bHasCost && !Entry.StatName.IsNone())
+			{
+				const double CostMs = GetCostMs(Entry);
+				UE_LOG(LogTemp, Log, TEXT("%8.3f ms  interval %5.2f  %-20s %s (%s)"), CostMs, Entry.Interval, *Group,
+				       *Entry.Name, *Entry.ClassName);
+				TotalMs += CostMs;
+			}
+			else
+			{
+				UE_LOG(LogTemp, Log, TEXT("     n/a     interval %5.2f  %-20s %s (%s)"), Entry.Interval, *Group,
+				       *Entry.Name, *Entry.ClassName);
+			}
+		}
+		if (bHasCost)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Tick audit: %d enabled tick functions, %.3f ms per frame over %d frames"),
+			       Capture.Entries.Num(), TotalMs, Capture.NumFrames);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Log, TEXT("Tick audit: %d enabled tick functions, no stats to cost them"),
+			       Capture.Entries.Num());
+		}
+	}
+
+#if STATS
+	/** Stats thread: add one frame of the tick functions' stats to the capture, and report after the last */
+	void OnNewStatsFrame(int64 Frame, TSharedRef<FCapture, ESPMode::ThreadSafe> Capture)
+	{
+		if (Capture->FramesLeft <= 0)
+		{
+			return;
+		}
+
+		FStatsThreadState& State = FStatsThreadState::GetLocalState();
+		TArray<FStatMessage> Stats;
+		State.GetInclusiveAggregateStackStats(Frame, Stats);
+		for (const FStatMessage& Stat : Stats)
+		{
+			if (!Stat.NameAndInfo.GetFlag(EStatMetaFlags::IsPackedCCAndDuration))
+			{
+				continue;
+			}
+			if (const int32* Index = Capture->EntryByStat.Find(Stat.NameAndInfo.GetRawName()))
+			{
+				Capture->Entries[*Index].Cycles += Stat.GetValue_Duration();
+			}
+		}
+
+		if (--Capture->FramesLeft == 0)
+		{
+			State.NewFrameDelegate.Remove(Capture->NewFrameHandle);
+			AsyncTask(ENamedThreads::GameThread, [Capture]()
+			{
+				Report(*Capture);
+				StatsMasterEnableSubtract();
+			});
+		}
+	}
+#endif
+
+	void Run(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+		const bool bModuleOnly = Args.Contains(TEXT("Module"));
+		int32 NumFrames = 60;
+		for (const FString& Arg : Args)
+		{
+			FParse::Value(*Arg, TEXT("Frames="), NumFrames);
+		}
+		const UPackage* ModulePackage = FindPackage(nullptr, TEXT("/Script/ShooterTemplate"));
+
+		// Only reads the tick functions. Nothing is ticked here, the cost comes from the frames that follow
+		TSharedRef<FCapture, ESPMode::ThreadSafe> Capture = MakeShared<FCapture, ESPMode::ThreadSafe>();
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			const AActor* Actor = *It;
+			const UClass* NativeClass = FindNativeClass(Actor->GetClass());
+			if (bModuleOnly && (NativeClass == nullptr || NativeClass->GetOutermost() != ModulePackage))
+			{
+				continue;
+			}
+
+			const FActorTickFunction& ActorTick = Actor->PrimaryActorTick;
+			if (ActorTick.IsTickFunctionRegistered() && ActorTick.IsTickFunctionEnabled())
+			{
+				AddEntry(*Capture, Actor, Actor->GetName(), ActorTick);
+			}
+
+			for (const UActorComponent* Component : Actor->GetComponents())
+			{
+				if (Component == nullptr)
+				{
+					continue;
+				}
+				const FActorComponentTickFunction& ComponentTick = Component->PrimaryComponentTick;
+				if (ComponentTick.IsTickFunctionRegistered() && ComponentTick.IsTickFunctionEnabled())
+				{
+					AddEntry(*Capture, Component, Actor->GetName() + TEXT(".") + Component->GetName(), ComponentTick);
+				}
+			}
+		}
+
+#if STATS
+		if (NumFrames > 0 && Capture->EntryByStat.Num() > 0)
+		{
+			// Each actor and component tick runs under its object's cycle stat, so the stats already time them
+			Capture->NumFrames = NumFrames;
+			Capture->FramesLeft = NumFrames;
+			StatsMasterEnableAdd();
+			FStatsThreadState& State = FStatsThreadState::GetLocalState();
+			Capture->NewFrameHandle = State.NewFrameDelegate.AddStatic(&OnNewStatsFrame, Capture);
+			UE_LOG(LogTemp, Log, TEXT("Tick audit: %d enabled tick functions, capturing their stats over %d frames"),
+			       Capture->Entries.Num(), NumFrames);
+			return;
+		}
+#endif
+		Report(*Capture);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs TickAuditCommand(
+	TEXT("Shooter.Tick.Audit"),
+	TEXT("List every actor and component with an enabled tick, with its interval and tick group. With stats, the ")
+	TEXT("average cost per frame of each is taken from their tick stats over the next Frames=N frames (60 by ")
+	TEXT("default), most expensive first. Pass Module to only list classes from this module and their blueprints."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&TickAudit::Run));
+
+#endif
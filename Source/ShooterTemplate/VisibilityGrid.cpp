@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VisibilityGrid.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+
+FVisibilityGrid::~FVisibilityGrid()
+{
+	Unload();
+}
+
+bool FVisibilityGrid::Load(const FString& Filename)
+{
+	Unload();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	MappedFile = PlatformFile.OpenMapped(*Filename);
+	if (MappedFile)
+	{
+		MappedRegion = MappedFile->MapRegion();
+		if (MappedRegion && Bind(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize()))
+		{
+			return true;
+		}
+		Unload();
+	}
+
+	if (!FFileHelper::LoadFileToArray(LoadedData, *Filename, FILEREAD_Silent) ||
+		!Bind(LoadedData.GetData(), LoadedData.Num()))
+	{
+		Unload();
+		return false;
+	}
+	return true;
+}
+
+void FVisibilityGrid::Unload()
+{
+	Header = nullptr;
+	OpenIndices = nullptr;
+	PairBits = nullptr;
+	delete MappedRegion;
+	MappedRegion = nullptr;
+	delete MappedFile;
+	MappedFile = nullptr;
+	LoadedData.Empty();
+}
+
+EVisibilityGridResult FVisibilityGrid::Query(const FVector& From, const FVector& To) const
+{
+	if (Header == nullptr || FVector::DistSquared(From, To) > FMath::Square(Header->MaxDistance))
+	{
+		return EVisibilityGridResult::Unknown;
+	}
+
+	const int32 CellA = CellIndexAt(From);
+	const int32 CellB = CellIndexAt(To);
+	if (CellA == INDEX_NONE || CellB == INDEX_NONE)
+	{
+		return EVisibilityGridResult::Unknown;
+	}
+
+	// Solid cells are INDEX_NONE. Anything else outside the open cells is a corrupt table, and would read
+	// past the bits
+	const int32 OpenA = OpenIndices[CellA];
+	const int32 OpenB = OpenIndices[CellB];
+	if (OpenA < 0 || OpenB < 0 || OpenA >= Header->NumOpenCells || OpenB >= Header->NumOpenCells)
+	{
+		return EVisibilityGridResult::Unknown;
+	}
+
+	const uint64 Bit = PairBitIndex(OpenA, OpenB, Header->NumOpenCells);
+	return PairBits[Bit >> 3] & (1 << (Bit & 7)) ? EVisibilityGridResult::Visible : EVisibilityGridResult::Hidden;
+}
+
+uint64 FVisibilityGrid::FileSize(int32 NumCells, int32 NumOpenCells)
+{
+	return sizeof(FVisibilityGridHeader) + NumCells * sizeof(int32) + NumPairBytes(NumOpenCells);
+}
+
+int32 FVisibilityGrid::CellIndexAt(const FVector& Location) const
+{
+	const int32 X = FMath::FloorToInt((Location.X - Header->OriginX) / Header->CellSize);
+	const int32 Y = FMath::FloorToInt((Location.Y - Header->OriginY) / Header->CellSize);
+	const int32 Z = FMath::FloorToInt((Location.Z - Header->OriginZ) / Header->CellSize);
+	if (X < 0 || Y < 0 || Z < 0 || X >= Header->SizeX || Y >= Header->SizeY || Z >= Header->SizeZ)
+	{
+		return INDEX_NONE;
+	}
+	return (Z * Header->SizeY + Y) * Header->SizeX + X;
+}
+
+bool FVisibilityGrid::Bind(const uint8* Data, int64 Size)
+{
+	if (Data == nullptr || Size < static_cast<int64>(sizeof(FVisibilityGridHeader)))
+	{
+		return false;
+	}
+
+	const FVisibilityGridHeader* NewHeader = reinterpret_cast<const FVisibilityGridHeader*>(Data);
+	if (NewHeader->Magic != FVisibilityGridHeader::ExpectedMagic ||
+		NewHeader->Version != FVisibilityGridHeader::ExpectedVersion || NewHeader->CellSize <= 0.f)
+	{
+		return false;
+	}
+
+	// Cell indices are int32, so the cell count has to fit one. Multiplied in 64 bits so a bad header can't wrap
+	if (NewHeader->SizeX <= 0 || NewHeader->SizeY <= 0 || NewHeader->SizeZ <= 0)
+	{
+		return false;
+	}
+	const int64 NumCells64 = static_cast<int64>(NewHeader->SizeX) * NewHeader->SizeY * NewHeader->SizeZ;
+	if (NumCells64 > MAX_int32 || NewHeader->NumOpenCells < 0 || NewHeader->NumOpenCells > NumCells64)
+	{
+		return false;
+	}
+
+	// A truncated file would read past the end
+	const int32 NumCells = static_cast<int32>(NumCells64);
+	if (static_cast<uint64>(Size) < FileSize(NumCells, NewHeader->NumOpenCells))
+	{
+		return false;
+	}
+
+	Header = NewHeader;
+	OpenIndices = reinterpret_cast<const int32*>(Data + sizeof(FVisibilityGridHeader));
+	PairBits = Data + sizeof(FVisibilityGridHeader) + NumCells * sizeof(int32);
+	return true;
+}
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/** What the baked grid knows about a line of sight */
+enum class EVisibilityGridResult : uint8
+{
+	Visible,
+	Hidden,
+	/** Outside the grid, inside geometry or beyond the baked distance. Needs a real trace */
+	Unknown
+};
+
+/** Start of a baked grid file. The cell table and the visibility bits follow it */
+struct FVisibilityGridHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x47535650; // "PVSG"
+	static constexpr uint32 ExpectedVersion = 1;
+
+	uint32 Magic{ExpectedMagic};
+	uint32 Version{ExpectedVersion};
+	float OriginX{0.f};
+	float OriginY{0.f};
+	float OriginZ{0.f};
+	float CellSize{0.f};
+	int32 SizeX{0};
+	int32 SizeY{0};
+	int32 SizeZ{0};
+
+	/** Pairs of cells further apart than this were not baked */
+	float MaxDistance{0.f};
+
+	/** Cells not inside static geometry. Only these have visibility bits */
+	int32 NumOpenCells{0};
+};
+
+/**
+ * Cell-to-cell line of sight over a level's static geometry, baked offline by the BakeVisibilityGrid
+ * commandlet. Only open cells get an index, and since visibility is symmetric only the upper triangle
+ * of the open cell matrix is stored, one bit per pair. The file is memory-mapped, so a grid costs no
+ * load time and only the pages that are queried become resident.
+ *
+ * Layout: FVisibilityGridHeader, int32 open index per cell (INDEX_NONE for solid cells), then the bits.
+ */
+class SHOOTERTEMPLATE_API FVisibilityGrid
+{
+public:
+	FVisibilityGrid() = default;
+	~FVisibilityGrid();
+
+	FVisibilityGrid(const FVisibilityGrid&) = delete;
+	FVisibilityGrid& operator=(const FVisibilityGrid&) = delete;
+
+	/** Map a baked grid file. Falls back to reading it whole where mapping isn't supported */
+	bool Load(const FString& Filename);
+
+	void Unload();
+
+	FORCEINLINE bool IsLoaded() const { return Header != nullptr; }
+
+	/** Baked line of sight between the cells containing From and To */
+	EVisibilityGridResult Query(const FVector& From, const FVector& To) const;
+
+	/** Bit index of the pair of open cells A and B, in either order */
+	static FORCEINLINE uint64 PairBitIndex(int32 OpenA, int32 OpenB, int32 NumOpenCells)
+	{
+		const uint64 Low = FMath::Min(OpenA, OpenB);
+		const uint64 High = FMath::Max(OpenA, OpenB);
+		// Rows of the upper triangle, diagonal included, shrink by one per row
+		return Low * NumOpenCells - Low * (Low - 1) / 2 + (High - Low);
+	}
+
+	static FORCEINLINE uint64 NumPairBytes(int32 NumOpenCells)
+	{
+		const uint64 NumPairs = static_cast<uint64>(NumOpenCells) * (NumOpenCells + 1) / 2;
+		return (NumPairs + 7) / 8;
+	}
+
+	/** Total file size for a grid with these dimensions */
+	static uint64 FileSize(int32 NumCells, int32 NumOpenCells);
+
+private:
+	/** Linear index of the cell containing Location, INDEX_NONE outside the grid */
+	int32 CellIndexAt(const FVector& Location) const;
+
+	bool Bind(const uint8* Data, int64 Size);
+
+	IMappedFileHandle* MappedFile{nullptr};
+	IMappedFileRegion* MappedRegion{nullptr};
+
+	/** Used when the platform can't map the file */
+	TArray<uint8> LoadedData;
+
+	const FVisibilityGridHeader* Header{nullptr};
+	const int32* OpenIndices{nullptr};
+	const uint8* PairBits{nullptr};
+};
@@ -4,13 +4,20 @@
 #include "Weapon.h"
 
 #include "DrawDebugHelpers.h"
+#include "FXPoolSubsystem.h"
+#include "PelletPattern.h"
+#include "ProjectileSubsystem.h"
+#include "ShooterTemplate.h"
+#include "GameFramework/GameStateBase.h"
 #include "Kismet/GameplayStatics.h"
+#include "Particles/ParticleSystem.h"
+#include "Sound/SoundCue.h"
 
 // Sets default values
 AWeapon::AWeapon()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Nothing to do per frame
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Create weapon root component and mesh component
 	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Weapon Root Component"));
@@ -21,8 +28,8 @@ AWeapon::AWeapon()
 
 void AWeapon::PullTrigger()
 {
-	UGameplayStatics::SpawnEmitterAttached(MuzzleFlash, Mesh,TEXT("MuzzleFlashSocket"));
-
+	SHOOTER_SCOPE_CYCLE_COUNTER(STAT_ShooterFireWeapon);
+	SHOOTER_INC_COUNTER(STAT_ShooterShots, 1);
 	APawn* OwnerPawn = Cast<APawn>(GetOwner());
 	if (OwnerPawn == nullptr) { return; }
 	AController* OwnerController = OwnerPawn->GetController();
@@ -32,38 +39,178 @@ void AWeapon::PullTrigger()
 	FRotator Rotation;
 	OwnerController->GetPlayerViewPoint(Location, Rotation);
 
-	FVector End = Location + Rotation.Vector() * MaxRange;
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	const float FireTime = GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+	Fire(Location, Rotation.Vector(), FireTime, GetSpreadSeed(ShotsFired++),
+	     FOnShotResolved::CreateUObject(this, &AWeapon::OnShotResolved));
+}
+
+void AWeapon::Fire(const FVector& AimStart, const FVector& AimDirection, float FireTime, uint32 SpreadSeed,
+                   const FOnShotResolved& OnResolved)
+{
+	APawn* OwnerPawn = Cast<APawn>(GetOwner());
+	if (Definition == nullptr || OwnerPawn == nullptr) { return; }
+
+	// Null until the combat bundle is resident, and then the shot goes out without FX
+	const UShooterCombatAssets* Assets = CombatAssets.Get();
+	const FTransform MuzzleTransform = GetMuzzleTransform();
+	UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+	if (FXPool && Assets)
+	{
+		// Attached, so the flash follows the weapon while it plays
+		FXPool->SpawnAttached(Assets->MuzzleFlash.Get(), Mesh, Definition->MuzzleSocket);
+	}
+	if (Assets && Assets->FireSound.Get())
+	{
+		UGameplayStatics::PlaySoundAtLocation(this, Assets->FireSound.Get(), MuzzleTransform.GetLocation());
+	}
+
+	AController* OwnerController = OwnerPawn->GetController();
+
+	if (Definition->bFireProjectiles)
+	{
+		UProjectileSubsystem* Projectiles = GetWorld()->GetSubsystem<UProjectileSubsystem>();
+		if (Projectiles == nullptr) { return; }
+
+		// Rounds leave the muzzle toward whatever the crosshairs are on, like the hitscan muzzle trace
+		const FVector MuzzleLocation = MuzzleTransform.GetLocation();
+		FVector AimPoint = AimStart + AimDirection * Definition->MaxRange;
+		FHitResult AimHit;
+		FCollisionQueryParams Params(SCENE_QUERY_STAT(WeaponAim), false, OwnerPawn);
+		Params.AddIgnoredActor(this);
+		SHOOTER_INC_COUNTER(STAT_ShooterTraces, 1);
+		if (GetWorld()->LineTraceSingleByChannel(AimHit, AimStart, AimPoint, ECollisionChannel::ECC_GameTraceChannel1,
+		                                         Params))
+		{
+			AimPoint = AimHit.ImpactPoint;
+		}
+		const FVector MuzzleDirection = (AimPoint - MuzzleLocation).GetSafeNormal();
 
-	FHitResult Hit;
-	FCollisionQueryParams Params;
-	Params.AddIgnoredActor(this);
-	Params.AddIgnoredActor(GetOwner());
+		FPelletDirections Directions;
+		FPelletPattern::Generate(SpreadSeed, Definition->PelletsPerShot, Definition->PelletSpread,
+		                         MuzzleDirection.IsNearlyZero() ? AimDirection : MuzzleDirection, Directions);
+		for (const FVector& Direction : Directions)
+		{
+			FProjectileSpawnParams Round;
+			Round.Location = MuzzleLocation;
+			Round.Velocity = Direction * Definition->MuzzleVelocity;
+			Round.Owner = OwnerPawn;
+			Round.DamageCauser = this;
+			Round.Instigator = OwnerController;
+			Round.Damage = Definition->Damage;
+			Round.ExplosionRadius = Definition->ExplosionRadius;
+			Round.ExplosionInnerRadius = Definition->ExplosionInnerRadius;
+			Round.ImpactEffect = Assets ? Assets->HitEffect.Get() : nullptr;
+			Projectiles->SpawnProjectile(Round);
+		}
+		return;
+	}
 
-	bool bSuccess = GetWorld()->LineTraceSingleByChannel(Hit, Location, End, ECollisionChannel::ECC_GameTraceChannel1,Params);
-	if (bSuccess)
+	UShotTraceSubsystem* ShotTrace = GetWorld()->GetSubsystem<UShotTraceSubsystem>();
+	if (ShotTrace == nullptr) { return; }
+
+	// Damage is dealt by the shot trace subsystem when the shot resolves
+	FShotRequest Shot;
+	Shot.Shooter = OwnerPawn;
+	Shot.DamageCauser = this;
+	Shot.Instigator = OwnerController;
+	Shot.AimStart = AimStart;
+	Shot.AimDirection = AimDirection;
+	Shot.Range = Definition->MaxRange;
+	Shot.MuzzleTransform = MuzzleTransform;
+	Shot.bTraceFromMuzzle = Muzzle.IsValid();
+	Shot.TraceChannel = ECollisionChannel::ECC_GameTraceChannel1;
+	Shot.Damage = Definition->Damage;
+	Shot.FireTime = FireTime;
+	Shot.NumPellets = Definition->PelletsPerShot;
+	Shot.SpreadAngle = Definition->PelletSpread;
+	Shot.SpreadSeed = SpreadSeed;
+	Shot.OnResolved = OnResolved;
+	ShotTrace->QueueShot(MoveTemp(Shot));
+}
+
+void AWeapon::OnShotResolved(const FShotRequest& Request, const FShotResult& Result)
+{
+	UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+	const UShooterCombatAssets* Assets = CombatAssets.Get();
+	if (FXPool == nullptr || Assets == nullptr)
 	{
-		// Direction of shot, and impact particle effect
-		FVector ShotDirection = -Rotation.Vector();
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), HitEffect, Hit.Location, ShotDirection.Rotation());
+		return;
+	}
 
-		// Deal Damage to Actor
-		AActor* HitActor = Hit.GetActor();
-		if (HitActor != nullptr)
+	// Impact particle effect facing back along each ray that hit
+	for (const FShotRayResult& Ray : Result.GetRays())
+	{
+		if (Ray.bBlockingHit)
 		{
-			FPointDamageEvent DamageEvent(Damage, Hit, ShotDirection, nullptr);
-			HitActor->TakeDamage(Damage, DamageEvent, OwnerController, this);
+			FXPool->SpawnAtLocation(Assets->HitEffect.Get(), Ray.Hit.Location, (-Ray.Direction).Rotation());
 		}
 	}
 }
 
+uint32 AWeapon::GetSpreadSeed(uint32 ShotIndex) const
+{
+	const int32 PelletSeed = Definition ? Definition->PelletSeed : 0;
+	return HashCombine(static_cast<uint32>(PelletSeed), ShotIndex);
+}
+
+void AWeapon::SetDefinition(UWeaponDefinition* NewDefinition)
+{
+	Definition = NewDefinition;
+	if (Definition == nullptr)
+	{
+		Muzzle = FResolvedSocket();
+		return;
+	}
+
+	Muzzle.Resolve(Mesh, Definition->MuzzleSocket);
+
+	// Pooled weapons that keep their variant keep its bundle
+	if (Definition->CombatAssetsId != LoadedAssetsId || CombatAssets.Get() == nullptr)
+	{
+		LoadedAssetsId = Definition->CombatAssetsId;
+		CombatAssets.Load(LoadedAssetsId, FSimpleDelegate::CreateUObject(this, &AWeapon::OnCombatAssetsLoaded));
+	}
+}
+
+void AWeapon::SetDormant(bool bDormant)
+{
+	SetActorHiddenInGame(bDormant);
+	SetActorEnableCollision(!bDormant);
+}
+
+FTransform AWeapon::GetMuzzleTransform() const
+{
+	return Muzzle.IsValid() ? Muzzle.GetTransform(Mesh) : Mesh->GetComponentTransform();
+}
+
 // Called when the game starts or when spawned
 void AWeapon::BeginPlay()
 {
 	Super::BeginPlay();
+
+	if (Definition)
+	{
+		SetDefinition(Definition);
+	}
+}
+
+void AWeapon::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	CombatAssets.Release();
+	Super::EndPlay(EndPlayReason);
 }
 
-// Called every frame
-void AWeapon::Tick(float DeltaTime)
+void AWeapon::OnCombatAssetsLoaded()
 {
-	Super::Tick(DeltaTime);
+	// Characters firing the weapon spawn the impact and beam FX
+	const UShooterCombatAssets* Assets = CombatAssets.Get();
+	UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+	if (Assets && FXPool)
+	{
+		FXPool->PrewarmPool(Assets->MuzzleFlash.Get());
+		FXPool->PrewarmPool(Assets->HitEffect.Get());
+		FXPool->PrewarmPool(Assets->ImpactParticles.Get());
+		FXPool->PrewarmPool(Assets->BeamParticles.Get());
+	}
 }
@@ -4,26 +4,68 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "ShooterCombatAssets.h"
+#include "ShotTraceSubsystem.h"
+#include "WeaponDefinition.h"
 #include "Weapon.generated.h"
 
+/**
+ * A weapon actor. Its stats, FX and sockets come from a UWeaponDefinition, which the weapon pool hands it
+ * when an inventory takes it. Without a definition it doesn't fire.
+ */
 UCLASS()
 class SHOOTERTEMPLATE_API AWeapon : public AActor
 {
 	GENERATED_BODY()
-	
-public:	
+
+public:
 	// Sets default values for this actor's properties
 	AWeapon();
 
+	/** Fire one shot along the owning controller's view */
 	void PullTrigger();
-	
+
+	/**
+	 * Fire one shot along an aim ray: the muzzle flash and sound, then a hitscan shot or rounds
+	 * @param FireTime server world time of the shot, for lag compensated hit claims
+	 * @param SpreadSeed picks the pellet pattern, from GetSpreadSeed
+	 * @param OnResolved called once a hitscan shot has been traced. Unused for projectile weapons
+	 */
+	void Fire(const FVector& AimStart, const FVector& AimDirection, float FireTime, uint32 SpreadSeed,
+	          const FOnShotResolved& OnResolved);
+
+	/**
+	 * Seed of a shot's pellet pattern, from the shooter's shot count. The server derives it the same way from
+	 * the count it expects, to replay the pattern when it checks hit claims
+	 */
+	uint32 GetSpreadSeed(uint32 ShotIndex) const;
+
+	/** Spawns the hit effect once a queued shot has been traced */
+	void OnShotResolved(const struct FShotRequest& Request, const struct FShotResult& Result);
+
+	/** Take on a definition: resolve its muzzle socket and start loading its combat assets */
+	void SetDefinition(UWeaponDefinition* NewDefinition);
+
+	/** Hidden and without collision while pooled or holstered */
+	void SetDormant(bool bDormant);
+
+	FORCEINLINE const UWeaponDefinition* GetDefinition() const { return Definition; }
+
+	/** Null until the definition's combat bundle is resident */
+	FORCEINLINE const UShooterCombatAssets* GetCombatAssets() const { return CombatAssets.Get(); }
+
+	/** Where shots leave the weapon, from the muzzle socket resolved with the definition */
+	FTransform GetMuzzleTransform() const;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	// Called when the weapon is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Builds the FX rings for the combat assets once they are resident */
+	void OnCombatAssetsLoaded();
 
 private:
 	UPROPERTY(VisibleAnywhere)
@@ -32,15 +74,19 @@ private:
 	UPROPERTY(VisibleAnywhere)
 	USkeletalMeshComponent* Mesh;
 
+	/** Stats, FX and sockets. Set here for placed weapons, by the weapon pool for pooled ones */
 	UPROPERTY(EditAnywhere)
-	UParticleSystem* MuzzleFlash;
+	UWeaponDefinition* Definition;
 
-	UPROPERTY(EditAnywhere)
-	UParticleSystem* HitEffect;
+	/** Shots skip their FX until the combat bundle is resident */
+	FCombatAssetsLoader CombatAssets;
 
-	UPROPERTY(EditAnywhere)
-	float MaxRange {10000};
+	/** The definition's combat assets the loader was last asked for */
+	FPrimaryAssetId LoadedAssetsId;
 
-	UPROPERTY(EditAnywhere)
-	float Damage {10};
+	/** The definition's muzzle socket on Mesh */
+	FResolvedSocket Muzzle;
+
+	/** Shots fired with PullTrigger since the weapon spawned. Picks their pellet patterns */
+	uint32 ShotsFired {0};
 };
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponDefinition.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMeshSocket.h"
+
+bool FResolvedSocket::Resolve(const USkeletalMeshComponent* Mesh, FName SocketName)
+{
+	const USkeletalMeshSocket* Socket = Mesh ? Mesh->GetSocketByName(SocketName) : nullptr;
+	BoneIndex = Socket ? Mesh->GetBoneIndex(Socket->BoneName) : INDEX_NONE;
+	LocalTransform = Socket ? Socket->GetSocketLocalTransform() : FTransform::Identity;
+	return IsValid();
+}
+
+FTransform FResolvedSocket::GetTransform(const USkeletalMeshComponent* Mesh) const
+{
+	return LocalTransform * Mesh->GetBoneTransform(BoneIndex);
+}
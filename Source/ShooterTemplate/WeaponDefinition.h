@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "FireScheduler.h"
+#include "WeaponDefinition.generated.h"
+
+class AWeapon;
+class USkeletalMeshComponent;
+
+/**
+ * A socket resolved to its bone index and local offset once, so a per-shot transform skips the name
+ * searches of GetSocketByName and GetBoneIndex.
+ */
+struct SHOOTERTEMPLATE_API FResolvedSocket
+{
+	/** Find SocketName on the component's current mesh. Returns false if it has no such socket */
+	bool Resolve(const USkeletalMeshComponent* Mesh, FName SocketName);
+
+	FORCEINLINE bool IsValid() const { return BoneIndex != INDEX_NONE; }
+
+	/** World transform of the socket. Only meaningful for the mesh it was resolved on */
+	FTransform GetTransform(const USkeletalMeshComponent* Mesh) const;
+
+private:
+	int32 BoneIndex{INDEX_NONE};
+	FTransform LocalTransform;
+};
+
+/**
+ * Everything that makes up one weapon: the actor pooled for it, how it fires, and which sounds, FX and
+ * montage section it uses. The combat assets are soft referenced and loaded without blocking by the
+ * weapon actor. Socket names are resolved once, when a weapon actor takes the definition.
+ */
+UCLASS(BlueprintType)
+class SHOOTERTEMPLATE_API UWeaponDefinition : public UDataAsset
+{
+	GENERATED_BODY()
+public:
+	/** Actor spawned, or taken from the weapon pool, for this weapon */
+	UPROPERTY(EditDefaultsOnly, Category = Weapon)
+	TSubclassOf<AWeapon> WeaponClass;
+
+	/** How the trigger fires */
+	UPROPERTY(EditDefaultsOnly, Category = Firing)
+	EFireMode FireMode{EFireMode::SemiAuto};
+
+	/** Rate of fire for burst and full auto, and the cooldown between semi auto shots */
+	UPROPERTY(EditDefaultsOnly, Category = Firing)
+	float RoundsPerMinute{600.f};
+
+	/** Shots per trigger pull in burst mode */
+	UPROPERTY(EditDefaultsOnly, Category = Firing, meta = (EditCondition = "FireMode == EFireMode::Burst"))
+	int32 BurstCount{3};
+
+	/** Per pellet */
+	UPROPERTY(EditDefaultsOnly, Category = Firing)
+	float Damage{10.f};
+
+	UPROPERTY(EditDefaultsOnly, Category = Firing)
+	float MaxRange{10000.f};
+
+	/** Rays or rounds per shot. Above one, the weapon fires a seeded spread pattern like a shotgun */
+	UPROPERTY(EditDefaultsOnly, Category = Firing, meta = (ClampMin = "1"))
+	int32 PelletsPerShot{1};
+
+	/** Half angle of the pellet spread, in degrees */
+	UPROPERTY(EditDefaultsOnly, Category = Firing, meta = (EditCondition = "PelletsPerShot > 1"))
+	float PelletSpread{5.f};
+
+	/** Shot N of every weapon with this seed fires the same pellet pattern, on the server and on clients */
+	UPROPERTY(EditDefaultsOnly, Category = Firing, meta = (EditCondition = "PelletsPerShot > 1"))
+	int32 PelletSeed{0};
+
+	/** Fire simulated rounds with travel time and drop instead of hitscan */
+	UPROPERTY(EditDefaultsOnly, Category = Firing)
+	bool bFireProjectiles{false};
+
+	/** Speed of simulated rounds, in cm/s */
+	UPROPERTY(EditDefaultsOnly, Category = Firing, meta = (EditCondition = "bFireProjectiles"))
+	float MuzzleVelocity{40000.f};
+
+	/** Rounds explode on impact, like grenades, when above zero. Damage falls off to nothing at this radius */
+	UPROPERTY(EditDefaultsOnly, Category = Firing, meta = (EditCondition = "bFireProjectiles"))
+	float ExplosionRadius{0.f};
+
+	/** Full damage within this distance of an explosion */
+	UPROPERTY(EditDefaultsOnly, Category = Firing, meta = (EditCondition = "bFireProjectiles"))
+	float ExplosionInnerRadius{0.f};
+
+	/** Sounds, FX and the fire montage */
+	UPROPERTY(EditDefaultsOnly, Category = Presentation, meta = (AllowedTypes = "ShooterCombatAssets"))
+	FPrimaryAssetId CombatAssetsId;
+
+	/** Socket on the weapon mesh that shots and the muzzle flash leave from */
+	UPROPERTY(EditDefaultsOnly, Category = Presentation)
+	FName MuzzleSocket{TEXT("MuzzleFlashSocket")};
+
+	/** Section of the combat assets' fire montage played for each shot */
+	UPROPERTY(EditDefaultsOnly, Category = Presentation)
+	FName FireMontageSection{TEXT("StartFire")};
+
+	/** Beam particle parameter set to where the shot landed */
+	UPROPERTY(EditDefaultsOnly, Category = Presentation)
+	FName BeamTargetParameter{TEXT("Target")};
+};
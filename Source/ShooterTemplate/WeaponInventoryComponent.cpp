@@ -0,0 +1,159 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponInventoryComponent.h"
+
+#include "Weapon.h"
+#include "WeaponDefinition.h"
+#include "WeaponPoolSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/Character.h"
+#include "Net/UnrealNetwork.h"
+
+UWeaponInventoryComponent::UWeaponInventoryComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+}
+
+void UWeaponInventoryComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const ACharacter* Character = Cast<ACharacter>(GetOwner());
+	USkeletalMeshComponent* OwnerMesh = Character ? Character->GetMesh() : nullptr;
+	UWeaponPoolSubsystem* WeaponPool = GetWorld()->GetSubsystem<UWeaponPoolSubsystem>();
+	if (OwnerMesh == nullptr || WeaponPool == nullptr)
+	{
+		return;
+	}
+
+	BuiltInWeaponBoneIndex = BuiltInWeaponBone.IsNone() ? INDEX_NONE : OwnerMesh->GetBoneIndex(BuiltInWeaponBone);
+	for (UWeaponDefinition* Definition : StartingWeapons)
+	{
+		if (AWeapon* Weapon = WeaponPool->AcquireWeapon(Definition, GetOwner()))
+		{
+			Weapon->AttachToComponent(OwnerMesh, FAttachmentTransformRules::SnapToTargetNotIncludingScale,
+			                          AttachSocket);
+			Weapons.Add(Weapon);
+		}
+	}
+
+	// Clients show slot 0 until the server says otherwise
+	const int32 FirstSlot = EquippedSlot != INDEX_NONE ? EquippedSlot : 0;
+	if (GetOwner()->HasAuthority())
+	{
+		EquipSlot(FirstSlot);
+	}
+	else
+	{
+		ShowSlot(FirstSlot);
+	}
+}
+
+void UWeaponInventoryComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Otherwise the world is going away, weapons included
+	if (EndPlayReason == EEndPlayReason::Destroyed)
+	{
+		if (UWeaponPoolSubsystem* WeaponPool = GetWorld()->GetSubsystem<UWeaponPoolSubsystem>())
+		{
+			for (AWeapon* Weapon : Weapons)
+			{
+				WeaponPool->ReleaseWeapon(Weapon);
+			}
+		}
+	}
+	Weapons.Reset();
+	ShownSlot = INDEX_NONE;
+	Super::EndPlay(EndPlayReason);
+}
+
+void UWeaponInventoryComponent::EquipSlot(int32 Slot)
+{
+	if (!Weapons.IsValidIndex(Slot))
+	{
+		return;
+	}
+
+	ShowSlot(Slot);
+	if (GetOwner()->HasAuthority())
+	{
+		EquippedSlot = Slot;
+	}
+	else
+	{
+		ServerEquipSlot(Slot);
+	}
+}
+
+void UWeaponInventoryComponent::EquipNextWeapon()
+{
+	if (Weapons.Num() > 0)
+	{
+		EquipSlot((ShownSlot + 1) % Weapons.Num());
+	}
+}
+
+AWeapon* UWeaponInventoryComponent::GetEquippedWeapon() const
+{
+	return Weapons.IsValidIndex(ShownSlot) ? Weapons[ShownSlot] : nullptr;
+}
+
+const UWeaponDefinition* UWeaponInventoryComponent::GetEquippedDefinition() const
+{
+	const AWeapon* Weapon = GetEquippedWeapon();
+	return Weapon ? Weapon->GetDefinition() : nullptr;
+}
+
+void UWeaponInventoryComponent::SetDormant(bool bNewDormant)
+{
+	bDormant = bNewDormant;
+	if (AWeapon* Weapon = GetEquippedWeapon())
+	{
+		Weapon->SetDormant(bDormant);
+	}
+}
+
+void UWeaponInventoryComponent::ShowSlot(int32 Slot)
+{
+	if (Slot == ShownSlot || !Weapons.IsValidIndex(Slot))
+	{
+		return;
+	}
+
+	if (AWeapon* Previous = GetEquippedWeapon())
+	{
+		Previous->SetDormant(true);
+	}
+	ShownSlot = Slot;
+	Weapons[Slot]->SetDormant(bDormant);
+
+	const ACharacter* Character = Cast<ACharacter>(GetOwner());
+	if (Character && BuiltInWeaponBoneIndex != INDEX_NONE)
+	{
+		Character->GetMesh()->HideBone(BuiltInWeaponBoneIndex, EPhysBodyOp::PBO_None);
+	}
+	OnEquippedWeaponChanged.Broadcast(Weapons[Slot]);
+}
+
+void UWeaponInventoryComponent::OnRep_EquippedSlot()
+{
+	ShowSlot(EquippedSlot);
+}
+
+bool UWeaponInventoryComponent::ServerEquipSlot_Validate(int32 Slot)
+{
+	return Slot >= 0;
+}
+
+void UWeaponInventoryComponent::ServerEquipSlot_Implementation(int32 Slot)
+{
+	EquipSlot(Slot);
+}
+
+void UWeaponInventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME_CONDITION(UWeaponInventoryComponent, EquippedSlot, COND_SkipOwner);
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "WeaponInventoryComponent.generated.h"
+
+class AWeapon;
+class UWeaponDefinition;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnEquippedWeaponChanged, AWeapon*);
+
+/**
+ * The weapons a character carries. One pooled weapon actor per starting definition is taken from the
+ * weapon pool at begin play and attached to the owner's mesh, and swapping only shows one and hides the
+ * rest. The owner's choice applies locally at once and is sent to the server, which replicates it to
+ * everyone else. Weapons go back to the pool when the owner is destroyed, so pooled AI keep theirs.
+ */
+UCLASS(ClassGroup = Combat, meta = (BlueprintSpawnableComponent))
+class SHOOTERTEMPLATE_API UWeaponInventoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+public:
+	UWeaponInventoryComponent();
+
+	/** Switch to the weapon in Slot. Invalid slots are ignored */
+	void EquipSlot(int32 Slot);
+
+	/** Switch to the next slot, wrapping around */
+	void EquipNextWeapon();
+
+	/** Null while the owner carries no weapon, and fires with its own */
+	AWeapon* GetEquippedWeapon() const;
+	const UWeaponDefinition* GetEquippedDefinition() const;
+
+	/** Hide the equipped weapon while the owner waits in the pawn pool */
+	void SetDormant(bool bNewDormant);
+
+	/** The newly equipped weapon, on every machine */
+	FOnEquippedWeaponChanged OnEquippedWeaponChanged;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	/** Show the weapon in Slot and hide the one shown before */
+	void ShowSlot(int32 Slot);
+
+	UFUNCTION()
+	void OnRep_EquippedSlot();
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerEquipSlot(int32 Slot);
+
+	/** One slot per definition, in order. Slot 0 is equipped when play begins */
+	UPROPERTY(EditDefaultsOnly, Category = Combat)
+	TArray<UWeaponDefinition*> StartingWeapons;
+
+	/** Socket on the owner's mesh that weapons attach to */
+	UPROPERTY(EditDefaultsOnly, Category = Combat)
+	FName AttachSocket{TEXT("WeaponSocket")};
+
+	/** Bone of the weapon built into the owner's mesh, hidden while a weapon actor is shown. None if there is none */
+	UPROPERTY(EditDefaultsOnly, Category = Combat)
+	FName BuiltInWeaponBone{TEXT("weapon_r")};
+
+	/** BuiltInWeaponBone, resolved at begin play */
+	int32 BuiltInWeaponBoneIndex{INDEX_NONE};
+
+	UPROPERTY(Transient)
+	TArray<AWeapon*> Weapons;
+
+	/** The server's slot. Owners don't get it back, they already show their choice */
+	UPROPERTY(ReplicatedUsing = OnRep_EquippedSlot)
+	int32 EquippedSlot{INDEX_NONE};
+
+	/** The slot shown on this machine */
+	int32 ShownSlot{INDEX_NONE};
+
+	bool bDormant{false};
+};
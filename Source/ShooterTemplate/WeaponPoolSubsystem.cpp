@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponPoolSubsystem.h"
+
+#include "Weapon.h"
+#include "WeaponDefinition.h"
+#include "Engine/World.h"
+
+static FAutoConsoleCommandWithWorld WeaponPoolStatsCommand(
+	TEXT("Shooter.WeaponPool.Stats"),
+	TEXT("Log the weapon pool hit/miss counters and dormant weapons for the current world."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+	{
+		const UWeaponPoolSubsystem* WeaponPool = World ? World->GetSubsystem<UWeaponPoolSubsystem>() : nullptr;
+		if (WeaponPool)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Weapon pool: %d hits, %d misses, %d dormant"),
+			       WeaponPool->GetNumHits(), WeaponPool->GetNumMisses(), WeaponPool->GetNumDormant());
+		}
+	}));
+
+void UWeaponPoolSubsystem::Deinitialize()
+{
+	// The world is going away with the pooled weapons in it
+	Pools.Reset();
+	Super::Deinitialize();
+}
+
+AWeapon* UWeaponPoolSubsystem::AcquireWeapon(UWeaponDefinition* Definition, AActor* Owner)
+{
+	if (Definition == nullptr || Definition->WeaponClass == nullptr)
+	{
+		return nullptr;
+	}
+
+	AWeapon* Weapon = nullptr;
+	if (FWeaponPool* Pool = Pools.Find(Definition->WeaponClass))
+	{
+		while (Weapon == nullptr && Pool->Dormant.Num() > 0)
+		{
+			AWeapon* Candidate = Pool->Dormant.Pop(false);
+			Weapon = IsValid(Candidate) ? Candidate : nullptr;
+		}
+	}
+
+	if (Weapon)
+	{
+		++NumHits;
+	}
+	else
+	{
+		++NumMisses;
+		FActorSpawnParameters Params;
+		Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		Weapon = GetWorld()->SpawnActor<AWeapon>(Definition->WeaponClass, FTransform::Identity, Params);
+		if (Weapon == nullptr)
+		{
+			return nullptr;
+		}
+	}
+
+	Weapon->SetOwner(Owner);
+	Weapon->SetDefinition(Definition);
+	Weapon->SetDormant(true);
+	return Weapon;
+}
+
+void UWeaponPoolSubsystem::ReleaseWeapon(AWeapon* Weapon)
+{
+	if (!IsValid(Weapon))
+	{
+		return;
+	}
+
+	Weapon->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	Weapon->SetOwner(nullptr);
+	Weapon->SetDormant(true);
+	Pools.FindOrAdd(Weapon->GetClass()).Dormant.Add(Weapon);
+}
+
+int32 UWeaponPoolSubsystem::GetNumDormant() const
+{
+	int32 NumDormant = 0;
+	for (const TPair<UClass*, FWeaponPool>& Pool : Pools)
+	{
+		NumDormant += Pool.Value.Dormant.Num();
+	}
+	return NumDormant;
+}
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WeaponPoolSubsystem.generated.h"
+
+class AWeapon;
+class UWeaponDefinition;
+
+/** Dormant weapons of one class, ready to be handed out */
+USTRUCT()
+struct FWeaponPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<AWeapon*> Dormant;
+};
+
+/**
+ * Reuses weapon actors instead of spawning them for every character. A released weapon is detached,
+ * hidden and kept until an inventory asks for one of its class again, with any definition.
+ */
+UCLASS()
+class SHOOTERTEMPLATE_API UWeaponPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	virtual void Deinitialize() override;
+
+	/**
+	 * A weapon of the definition's class, owned by Owner and set up from the definition. Taken from the
+	 * pool, or spawned if none is left. Dormant until equipped
+	 * @return null only if the definition has no weapon class or the spawn failed
+	 */
+	AWeapon* AcquireWeapon(UWeaponDefinition* Definition, AActor* Owner);
+
+	/** Hand a weapon back for the next AcquireWeapon of its class */
+	void ReleaseWeapon(AWeapon* Weapon);
+
+	int32 GetNumDormant() const;
+
+	/** Weapons handed out from the pool and spawned since the world started */
+	FORCEINLINE int32 GetNumHits() const { return NumHits; }
+	FORCEINLINE int32 GetNumMisses() const { return NumMisses; }
+
+private:
+	UPROPERTY(Transient)
+	TMap<UClass*, FWeaponPool> Pools;
+
+	int32 NumHits{0};
+	int32 NumMisses{0};
+};